@@ -0,0 +1,586 @@
+// Micro and macro benchmark of simulation hot paths
+// benchmark [--csv] [--seed seed] [--samples sample amount] [--rails rail amount]
+#define SIMULATE_NO_MAIN
+#define HEAP_ALLOCATION_COUNTER
+#include "simulate.cpp"
+
+#ifdef _WIN32
+  #define NULL_DEVICE "NUL"
+#else
+  #define NULL_DEVICE "/dev/null"
+#endif
+
+// Boards cycled by every scenario, so fixed and worst cases see the same cache pressure. Fixed-seed scenarios take
+// the first ones drawn, worst-case scenarios the ones with most bars out of WORST_BOARD_DRAW_AMOUNT draws
+#define BENCHMARK_BOARD_AMOUNT 64
+#define WORST_BOARD_DRAW_AMOUNT (4 * BENCHMARK_BOARD_AMOUNT)
+#define BENCHMARK_MASK_AMOUNT 4096
+// Timed passes over each candidate mask set of coherenceBetweenBar(), the fastest pass is its cost
+#define COHERENCE_CANDIDATE_PASS 5
+// Random offset tuples per evaluateOffsetTupleBatch() call
+#define BENCHMARK_BATCH_TUPLE_AMOUNT 1024
+// Encoder noise in unit offsets, beyond the hysteresis band so debouncing has work to do
+#define BENCHMARK_SENSOR_NOISE 0.4f
+// Period of each rail sweeping from end to end and back
+#define BENCHMARK_SENSOR_SWEEP_SECOND 4
+
+typedef struct BenchmarkResult {
+    const char *m_name;
+
+    int m_railAmount;
+
+    // Tracks times interleaved track positions of the board, mean time per cell shows how the size scales
+    int m_cellAmount;
+
+    // "fixed" runs fixed-seed boards and inputs, "worst" runs the densest boards with inputs forcing full work
+    const char *m_scenario;
+
+    size_t m_callAmount;
+
+    // Nanosecond per call, sorted
+    std::vector<double> m_sample;
+
+    double m_totalSecond;
+
+    // Heap allocations of the timed calls, warm-up excluded
+    size_t m_heapAllocation;
+
+} BenchmarkResult;
+
+typedef struct BenchmarkContext {
+    uint64_t m_seed;
+
+    size_t m_sampleAmount;
+
+    // Rail amount and cells of the board size being benchmarked
+    int m_railAmount;
+    int m_cellAmount;
+
+    // Stand-in terminal, output is written and dropped
+    FILE *m_nullSink;
+
+    std::vector<BenchmarkResult> m_resultList;
+
+} BenchmarkContext;
+
+template <typename Board>
+struct BenchmarkBoardSet {
+    std::vector<GameStatus<Board> *> m_boardList;
+
+    std::vector<GameStatus<Board> *> m_worstBoardList;
+
+};
+
+// Time sampleAmount samples of callPerSample calls each, cheap calls are batched so clock overhead doesn't dominate
+template<typename Call>
+void runBenchmark (BenchmarkContext *context, const char *name, const char *scenario, size_t sampleAmount, size_t callPerSample, Call call) {
+    BenchmarkResult result;
+    result.m_name = name;
+    result.m_railAmount = context->m_railAmount;
+    result.m_cellAmount = context->m_cellAmount;
+    result.m_scenario = scenario;
+    result.m_callAmount = sampleAmount * callPerSample;
+    result.m_sample.reserve(sampleAmount);
+    // Warm caches and lazily built tables first
+    for (size_t i = 0; i < callPerSample; ++i) {
+        call();
+    }
+    size_t heapAllocationBegin = threadHeapAllocation();
+    auto benchmarkBegin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sampleAmount; ++i) {
+        auto sampleBegin = std::chrono::steady_clock::now();
+        for (size_t j = 0; j < callPerSample; ++j) {
+            call();
+        }
+        auto sampleEnd = std::chrono::steady_clock::now();
+        result.m_sample.push_back(std::chrono::duration<double, std::nano>(sampleEnd - sampleBegin).count() / callPerSample);
+    }
+    result.m_totalSecond = std::chrono::duration<double>(std::chrono::steady_clock::now() - benchmarkBegin).count();
+    result.m_heapAllocation = threadHeapAllocation() - heapAllocationBegin;
+    std::sort(result.m_sample.begin(), result.m_sample.end());
+    context->m_resultList.push_back(result);
+}
+
+double percentile (const std::vector<double> &sortedSample, double ratio) {
+    if (sortedSample.empty()) {
+        return 0;
+    }
+    return sortedSample[static_cast<size_t>(ratio * (sortedSample.size() - 1) + 0.5)];
+}
+
+double mean (const std::vector<double> &sample) {
+    double sum = 0;
+    for (double value : sample) {
+        sum += value;
+    }
+    return sample.empty() ? 0 : sum / sample.size();
+}
+
+template <typename Board>
+int totalBarAmount (const GameStatus<Board> *game) {
+    int barAmount = 0;
+    for (int i = 0; i < Board::railAmount; ++i) {
+        barAmount += maskBitCount(game->m_railStatusList[i].m_activeBar);
+    }
+    return barAmount;
+}
+
+// Rail whose move retraces the most, an odd rail swaps on even positions, so with a bar at 0 and offset 0 it
+// swaps on position 0. The odd rail with the lowest bar is taken if none has a bar at 0.
+template <typename Board>
+int worstCaseRail (const GameStatus<Board> *game) {
+    int worstRail = 1;
+    for (int i = 1; i < Board::railAmount; i += 2) {
+        if (firstRailSwapPos<Board>(game->m_railStatusList[i].m_activeBar, 0, i) < firstRailSwapPos<Board>(game->m_railStatusList[worstRail].m_activeBar, 0, worstRail)) {
+            worstRail = i;
+        }
+    }
+    return worstRail;
+}
+
+// Offset level a rail moves to, never its current one so updateGameInfo() never takes its unchanged-tuple early out.
+// Worst case moves between 0 and another level, so refreshGameProgress() retraces from the rail's lowest bar at offset 0.
+template <typename Board>
+size_t nextRailOffset (size_t offset, RandomEngine *engine, bool isWorstCase, size_t levelAmount = Board::offsetLevelAmount) {
+    if (isWorstCase) {
+        return offset == 0 ? 1 + randomBelow(engine, levelAmount - 1) : 0;
+    }
+    return (offset + 1 + randomBelow(engine, levelAmount - 1)) % levelAmount;
+}
+
+// Worst case also moves the rail with the largest tuple stride, toggling alone would revisit one lookup entry
+// per board and keep it cached
+template <typename Board>
+void stepRailOffset (GameStatus<Board> *game, RandomEngine *engine, bool isWorstCase) {
+    if (!isWorstCase) {
+        RailStatus<Board> *rail = &game->m_railStatusList[randomBelow(engine, Board::railAmount)];
+        rail->m_offset = nextRailOffset<Board>(rail->m_offset, engine, false);
+        return;
+    }
+    int worstRail = worstCaseRail(game);
+    RailStatus<Board> *rail = &game->m_railStatusList[worstRail];
+    rail->m_offset = nextRailOffset<Board>(rail->m_offset, engine, true);
+    RailStatus<Board> *strideRail = &game->m_railStatusList[worstRail == Board::railAmount - 1 ? Board::railAmount - 2 : Board::railAmount - 1];
+    strideRail->m_offset = nextRailOffset<Board>(strideRail->m_offset, engine, false);
+}
+
+// Alternating runs of bars and gaps, each 1 to maxRun bars long
+template <typename Mask>
+Mask randomShortRunMask (RandomEngine *engine, int barAmount, int maxRun) {
+    Mask mask = Mask();
+    bool isBar = randomBelow(engine, 2) != 0;
+    for (int i = 0; i < barAmount; isBar = !isBar) {
+        for (size_t run = 1 + randomBelow(engine, maxRun); run > 0 && i < barAmount; --run, ++i) {
+            if (isBar) {
+                setMaskBit(&mask, i);
+            }
+        }
+    }
+    return mask;
+}
+
+template <typename Board>
+double coherenceMaskSetCost (const std::vector<RailStatus<Board> > &maskList) {
+    volatile float coherenceSink;
+    double cost = INFINITY;
+    for (int i = 0; i < COHERENCE_CANDIDATE_PASS; ++i) {
+        auto passBegin = std::chrono::steady_clock::now();
+        for (const RailStatus<Board> &rail : maskList) {
+            coherenceSink = coherenceBetweenBar(&rail);
+        }
+        cost = std::min(cost, std::chrono::duration<double>(std::chrono::steady_clock::now() - passBegin).count());
+    }
+    (void)coherenceSink;
+    return cost;
+}
+
+template <typename Board>
+void benchmarkGeneration (BenchmarkContext *context) {
+    RandomEngine engine;
+    seedRandomEngine(&engine, context->m_seed);
+    // Masks are drawn up front so the engine isn't timed
+    std::vector<RailStatus<Board> > maskList(BENCHMARK_MASK_AMOUNT);
+    for (RailStatus<Board> &rail : maskList) {
+        rail.m_activeBar = randomBernoulliMask<typename Board::BarMask>(&engine, 0.5f);
+    }
+    // coherenceBetweenBar() mostly pays for mispredicted bar branches rather than for bars, so dense masks are
+    // cheap. Worst case is the slowest of the fixed masks, masks drawn with 1/8 to 7/8 chance per bar and masks
+    // of short runs, timed on this machine.
+    std::vector<std::vector<RailStatus<Board> > > candidateList(1, maskList);
+    for (int i = 1; i < 8; ++i) {
+        candidateList.push_back(std::vector<RailStatus<Board> >(BENCHMARK_MASK_AMOUNT));
+        for (RailStatus<Board> &rail : candidateList.back()) {
+            rail.m_activeBar = randomBernoulliMask<typename Board::BarMask>(&engine, i / 8.0f);
+        }
+    }
+    for (int maxRun = 2; maxRun <= 3; ++maxRun) {
+        candidateList.push_back(std::vector<RailStatus<Board> >(BENCHMARK_MASK_AMOUNT));
+        for (RailStatus<Board> &rail : candidateList.back()) {
+            rail.m_activeBar = randomShortRunMask<typename Board::BarMask>(&engine, Board::barAmount, maxRun);
+        }
+    }
+    size_t worstCandidate = 0;
+    double worstCost = 0;
+    for (size_t i = 0; i < candidateList.size(); ++i) {
+        double cost = coherenceMaskSetCost(candidateList[i]);
+        if (cost > worstCost) {
+            worstCost = cost;
+            worstCandidate = i;
+        }
+    }
+    const std::vector<RailStatus<Board> > &worstMaskList = candidateList[worstCandidate];
+    size_t maskIndex = 0;
+    volatile float coherenceSink;
+    runBenchmark(context, "coherenceBetweenBar", "fixed", context->m_sampleAmount, 256, [&] () {
+        coherenceSink = coherenceBetweenBar(&maskList[maskIndex++ % BENCHMARK_MASK_AMOUNT]);
+    });
+    runBenchmark(context, "coherenceBetweenBar", "worst", context->m_sampleAmount, 256, [&] () {
+        coherenceSink = coherenceBetweenBar(&worstMaskList[maskIndex++ % BENCHMARK_MASK_AMOUNT]);
+    });
+    (void)coherenceSink;
+
+    RailStatus<Board> *railList = new RailStatus<Board>[Board::railAmount];
+    runBenchmark(context, "generateGhostLegGraph", "fixed", context->m_sampleAmount, 16, [&] () {
+        generateGhostLegGraph<Board>(railList, &engine);
+    });
+    delete [] railList;
+
+    // Whole board with offset space solving or rejection sampling, checkpoints and lookup table,
+    // a fresh board each call and then one board storage reused as a long-running kiosk does
+    runBenchmark(context, "generateGame", "fixed", std::max<size_t>(context->m_sampleAmount / 50, 20), 1, [&] () {
+        destroyGame(generateGame<Board>(&engine));
+    });
+    GameStatus<Board> *game = new GameStatus<Board>;
+    runBenchmark(context, "regenerateGame", "fixed", std::max<size_t>(context->m_sampleAmount / 50, 20), 1, [&] () {
+        regenerateGame(game, &engine);
+    });
+    destroyGame(game);
+}
+
+template <typename Board>
+void benchmarkBoard (BenchmarkContext *context, const BenchmarkBoardSet<Board> *boardSet, const char *scenario, bool isWorstCase) {
+    RandomEngine engine;
+    seedRandomEngine(&engine, context->m_seed + 1);
+    const std::vector<GameStatus<Board> *> &boardList = isWorstCase ? boardSet->m_worstBoardList : boardSet->m_boardList;
+    size_t boardIndex = 0;
+    auto nextBoard = [&] () {
+        GameStatus<Board> *game = boardList[boardIndex];
+        boardIndex = (boardIndex + 1) % boardList.size();
+        return game;
+    };
+
+    runBenchmark(context, "findAdmissibleAnswer", scenario, context->m_sampleAmount, 16, [&] () {
+        findAdmissibleAnswer(nextBoard(), &engine);
+    });
+
+    // Every start track through every position, SIMD lanes on wide boards
+    GhostLegTrace<Board> *trace = new GhostLegTrace<Board>();
+    runBenchmark(context, "traceSwapLayer", scenario, context->m_sampleAmount, 16, [&] () {
+        traceSwapLayer<Board>(nextBoard()->m_swapLayer, trace);
+    });
+    delete trace;
+
+    // Fixed random tuples on every board, one call evaluates the whole batch
+    OffsetTupleBatch<Board> *batch = createOffsetTupleBatch<Board>(BENCHMARK_BATCH_TUPLE_AMOUNT);
+    for (int i = 0; i < Board::railAmount; ++i) {
+        for (size_t k = 0; k < batch->m_tupleAmount; ++k) {
+            batch->m_offset[i * batch->m_tupleStride + k] = static_cast<uint16_t>(randomBelow(&engine, Board::offsetLevelAmount));
+        }
+    }
+    runBenchmark(context, "evaluateOffsetTupleBatch", scenario, context->m_sampleAmount / 10 + 1, 1, [&] () {
+        evaluateOffsetTupleBatch(nextBoard(), batch);
+    });
+    destroyOffsetTupleBatch(batch);
+
+    runBenchmark(context, "updateGameInfo", scenario, context->m_sampleAmount, 16, [&] () {
+        GameStatus<Board> *game = nextBoard();
+        stepRailOffset(game, &engine, isWorstCase);
+        updateGameInfo(game);
+    });
+
+    // Trace a frame needs after a lookup, the retrace starts from the lowest position the moved rails swap on
+    runBenchmark(context, "refreshGameProgress", scenario, context->m_sampleAmount, 16, [&] () {
+        GameStatus<Board> *game = nextBoard();
+        stepRailOffset(game, &engine, isWorstCase);
+        updateGameInfo(game);
+        refreshGameProgress(game);
+    });
+
+    volatile float progressSink;
+    runBenchmark(context, "progressBarUpdate", scenario, context->m_sampleAmount, 64, [&] () {
+        progressSink = progressBarUpdate(nextBoard());
+    });
+    (void)progressSink;
+
+    // Frames after one input each are captured up front, worst case redraws every cell instead of the difference from last frame
+    TimerScheduler scheduler;
+    std::vector<GameFrame<Board> > frameList(boardList.size() * 4);
+    for (size_t i = 0; i < frameList.size(); ++i) {
+        GameStatus<Board> *game = boardList[i % boardList.size()];
+        stepRailOffset(game, &engine, isWorstCase);
+        updateGameInfo(game);
+        captureGameFrame(game, &scheduler, &frameList[i]);
+    }
+    size_t frameIndex = 0;
+    ScreenBuffer *screen = new ScreenBuffer();
+    runBenchmark(context, "printGraph", scenario, context->m_sampleAmount, 4, [&] () {
+        if (isWorstCase) {
+            screen->m_isShown = false;
+        }
+        clearScreenBuffer(screen);
+        printGraph(&frameList[frameIndex++ % frameList.size()], screen);
+        flushScreenBuffer(screen, context->m_nullSink);
+    });
+    delete screen;
+}
+
+// Input event posted by the caller until the frame it causes is flushed, through a game loop thread as in simulate
+template <typename Board>
+void benchmarkInputToFrame (BenchmarkContext *context, const BenchmarkBoardSet<Board> *boardSet, const char *scenario, bool isWorstCase) {
+    RandomEngine engine;
+    seedRandomEngine(&engine, context->m_seed + 2);
+    GameStatus<Board> *game = isWorstCase ? boardSet->m_worstBoardList[0] : boardSet->m_boardList[0];
+    GameEventQueue<Board> eventQueue;
+    TimerScheduler scheduler;
+    FrameBuffer<Board> frameBuffer;
+    captureGameFrame(game, &scheduler, beginGameFrame(&frameBuffer));
+    publishGameFrame(&frameBuffer);
+    std::atomic<bool> isStopped(false);
+
+    std::thread gameLoop([&] () {
+        InputStatus<Board> loopInputStatus;
+        int loopInputRail = 0;
+        std::chrono::steady_clock::time_point inputTime;
+        while (true) {
+            uint32_t event = waitGameEvent(&eventQueue, INPUT_EVENT);
+            if (isStopped) {
+                break;
+            }
+            takeInput(&eventQueue, &loopInputStatus, &loopInputRail, &inputTime);
+            railInputUpdate(&loopInputStatus, game);
+            updateGameInfo(game);
+            eventDrivenCheckpointUpdate(&scheduler, game, &engine, std::chrono::steady_clock::now());
+            GameFrame<Board> *frame = beginGameFrame(&frameBuffer);
+            captureGameFrame(game, &scheduler, frame);
+            frame->m_inputStatus = loopInputStatus;
+            frame->m_currentInputRail = loopInputRail;
+            publishGameFrame(&frameBuffer);
+            postGameEvent(&eventQueue, REDRAW_EVENT);
+            (void)event;
+        }
+    });
+
+    InputStatus<Board> inputStatus;
+    for (int i = 0; i < Board::railAmount; ++i) {
+        inputStatus.m_physicalOffset[i] = game->m_railStatusList[i].m_offset * Board::unitPhysicalOffset;
+    }
+    ScreenBuffer *screen = new ScreenBuffer();
+    int worstRail = worstCaseRail(game);
+    runBenchmark(context, "inputToFrame", scenario, context->m_sampleAmount, 1, [&] () {
+        int rail = isWorstCase ? worstRail : static_cast<int>(randomBelow(&engine, Board::railAmount));
+        // Land in the middle of an offset level so float rounding never maps back to the same level
+        size_t offset = nextRailOffset<Board>(static_cast<size_t>(inputStatus.m_physicalOffset[rail] / Board::unitPhysicalOffset), &engine, isWorstCase, Board::offsetLevelAmount - 1);
+        inputStatus.m_physicalOffset[rail] = (offset + 0.5f) * Board::unitPhysicalOffset;
+        postInputEvent(&eventQueue, &inputStatus, rail);
+        waitGameEvent(&eventQueue, REDRAW_EVENT);
+        const GameFrame<Board> *frame = consumeGameFrame(&frameBuffer);
+        if (isWorstCase) {
+            screen->m_isShown = false;
+        }
+        clearScreenBuffer(screen);
+        printGraph(frame, screen);
+        flushScreenBuffer(screen, context->m_nullSink);
+    });
+    isStopped = true;
+    postGameEvent(&eventQueue, INPUT_EVENT);
+    gameLoop.join();
+    delete screen;
+}
+
+// One call is 1 ms of encoder samples of every rail, filtered and applied as the sensor thread and game loop do.
+// Rails sweep with noise, update work only follows level changes so call time should stay flat across rates.
+template <typename Board>
+void benchmarkSensorInput (BenchmarkContext *context, const BenchmarkBoardSet<Board> *boardSet) {
+    RandomEngine engine;
+    seedRandomEngine(&engine, context->m_seed + 3);
+    GameStatus<Board> *game = boardSet->m_boardList[0];
+    const int rateList[] = {1000, 8000, 64000};
+    const char *scenarioList[] = {"1kHz", "8kHz", "64kHz"};
+    for (int i = 0; i < 3; ++i) {
+        // One second of samples, interleaved across rails
+        int batchSample = rateList[i] / 1000;
+        std::vector<SensorSample> sampleList(static_cast<size_t>(rateList[i]) * Board::railAmount);
+        for (int j = 0; j < rateList[i]; ++j) {
+            for (int k = 0; k < Board::railAmount; ++k) {
+                float phase = fmodf(static_cast<float>(j) / rateList[i] + static_cast<float>(k) / Board::railAmount, BENCHMARK_SENSOR_SWEEP_SECOND) / BENCHMARK_SENSOR_SWEEP_SECOND;
+                float sweep = (phase < 0.5f ? 2 * phase : 2 - 2 * phase) * MAXIMUM_PHYSICAL_OFFSET_ON_RAIL;
+                float noise = (2 * randomFloat(&engine) - 1) * BENCHMARK_SENSOR_NOISE * Board::unitPhysicalOffset;
+                sampleList[static_cast<size_t>(j) * Board::railAmount + k] = {k, sweep + noise};
+            }
+        }
+        SensorFilter<Board> *filter = new SensorFilter<Board>();
+        InputStatus<Board> inputStatus;
+        size_t batchIndex = 0;
+        runBenchmark(context, "sensorInput", scenarioList[i], context->m_sampleAmount, 1, [&] () {
+            const SensorSample *sample = &sampleList[(batchIndex++ % 1000) * batchSample * Board::railAmount];
+            bool isChanged = false;
+            for (int j = 0; j < batchSample * Board::railAmount; ++j) {
+                isChanged |= filterSensorSample(filter, &sample[j]);
+            }
+            if (isChanged) {
+                sensorInputStatus(filter, &inputStatus);
+                railInputUpdate(&inputStatus, game);
+                updateGameInfo(game);
+            }
+        });
+        delete filter;
+    }
+}
+
+#ifdef OFFSET_HINT
+// Hint table solved from each board's complete tuples as the solver thread does, and hints of random offsets
+template <typename Board>
+void benchmarkOffsetHint (BenchmarkContext *context, const BenchmarkBoardSet<Board> *boardSet, std::true_type) {
+    RandomEngine engine;
+    seedRandomEngine(&engine, context->m_seed + 4);
+    std::vector<std::vector<uint64_t> > completeSetList;
+    for (const GameStatus<Board> *game : boardSet->m_boardList) {
+        std::vector<uint64_t> completeSet(Board::offsetTupleWords, 0);
+        for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+            if (LOOKUP_IS_COMPLETE(game->m_offsetSpace.m_offsetLookupTable[tuple])) {
+                completeSet[tuple / 64] |= uint64_t(1) << (tuple % 64);
+            }
+        }
+        completeSetList.push_back(completeSet);
+    }
+    HintTable<Board> *table = new HintTable<Board>();
+    size_t boardIndex = 0;
+    runBenchmark(context, "solveOffsetHint", "fixed", context->m_sampleAmount / 50 + 1, 1, [&] () {
+        solveOffsetHint(completeSetList[boardIndex++ % completeSetList.size()].data(), table);
+    });
+
+    // Table of the first board, queried on fixed random offsets
+    solveOffsetHint(completeSetList[0].data(), table);
+    std::vector<RailStatus<Board> > railList(BENCHMARK_BATCH_TUPLE_AMOUNT * Board::railAmount);
+    for (size_t i = 0; i < railList.size(); ++i) {
+        railList[i] = boardSet->m_boardList[0]->m_railStatusList[i % Board::railAmount];
+        railList[i].m_offset = randomBelow(&engine, Board::offsetLevelAmount);
+    }
+    OffsetHint hint;
+    size_t railIndex = 0;
+    runBenchmark(context, "findOffsetHint", "fixed", context->m_sampleAmount, 64, [&] () {
+        findOffsetHint(table, &railList[(railIndex++ % BENCHMARK_BATCH_TUPLE_AMOUNT) * Board::railAmount], &hint);
+    });
+    delete table;
+}
+
+template <typename Board>
+void benchmarkOffsetHint (BenchmarkContext *, const BenchmarkBoardSet<Board> *, std::false_type) {
+}
+#endif
+
+// Benchmark one board size, boards are drawn from context->m_seed so every size sees the same seed
+template <typename Board>
+struct BenchmarkTask {
+    static int run (BenchmarkContext *context) {
+        context->m_cellAmount = Board::trackAmount * Board::interleaveTrackPosAmount;
+        BenchmarkBoardSet<Board> boardSet;
+        RandomEngine engine;
+        seedRandomEngine(&engine, context->m_seed);
+        auto isFixedBoard = [&] (const GameStatus<Board> *game) {
+            return std::find(boardSet.m_boardList.begin(), boardSet.m_boardList.end(), game) != boardSet.m_boardList.end();
+        };
+        auto isDenser = [] (const GameStatus<Board> *a, const GameStatus<Board> *b) {
+            return totalBarAmount(a) > totalBarAmount(b);
+        };
+        // Only the densest boards so far are kept, so wide boards never hold every draw at once
+        for (int i = 0; i < WORST_BOARD_DRAW_AMOUNT; ++i) {
+            GameStatus<Board> *game = generateGame<Board>(&engine);
+            updateGameInfo(game);
+            if (i < BENCHMARK_BOARD_AMOUNT) {
+                boardSet.m_boardList.push_back(game);
+            }
+            boardSet.m_worstBoardList.push_back(game);
+            std::stable_sort(boardSet.m_worstBoardList.begin(), boardSet.m_worstBoardList.end(), isDenser);
+            if (boardSet.m_worstBoardList.size() > BENCHMARK_BOARD_AMOUNT) {
+                GameStatus<Board> *sparsest = boardSet.m_worstBoardList.back();
+                boardSet.m_worstBoardList.pop_back();
+                if (!isFixedBoard(sparsest)) {
+                    destroyGame(sparsest);
+                }
+            }
+        }
+
+        benchmarkGeneration<Board>(context);
+        benchmarkBoard(context, &boardSet, "fixed", false);
+        benchmarkBoard(context, &boardSet, "worst", true);
+        benchmarkInputToFrame(context, &boardSet, "fixed", false);
+        benchmarkInputToFrame(context, &boardSet, "worst", true);
+        benchmarkSensorInput(context, &boardSet);
+#ifdef OFFSET_HINT
+        benchmarkOffsetHint(context, &boardSet, OffsetSpaceSolvedTag<Board>());
+#endif
+
+        for (GameStatus<Board> *game : boardSet.m_worstBoardList) {
+            if (!isFixedBoard(game)) {
+                destroyGame(game);
+            }
+        }
+        for (GameStatus<Board> *game : boardSet.m_boardList) {
+            destroyGame(game);
+        }
+        return 0;
+    }
+};
+
+void printResult (const BenchmarkContext *context, bool isCsv) {
+    if (isCsv) {
+        printf("name,rails,scenario,calls,mean_ns,p50_ns,p90_ns,p99_ns,max_ns,calls_per_second,mean_ns_per_cell,allocations_per_call\n");
+    } else {
+        printf("Seed %llu, %zu samples, %s tracer\n\n", static_cast<unsigned long long>(context->m_seed), context->m_sampleAmount, TRACER_ISA);
+        printf("%-24s %5s %-8s %10s %12s %12s %12s %12s %12s %14s %10s %11s\n", "name", "rails", "scenario", "calls", "mean(ns)", "p50(ns)", "p90(ns)", "p99(ns)", "max(ns)", "calls/s", "ns/cell", "allocs/call");
+    }
+    for (const BenchmarkResult &result : context->m_resultList) {
+        const char *format = isCsv ? "%s,%d,%s,%zu,%.1lf,%.1lf,%.1lf,%.1lf,%.1lf,%.1lf,%.3lf,%.3lf\n" : "%-24s %5d %-8s %10zu %12.1lf %12.1lf %12.1lf %12.1lf %12.1lf %14.1lf %10.3lf %11.3lf\n";
+        printf(format, result.m_name, result.m_railAmount, result.m_scenario, result.m_callAmount, mean(result.m_sample),
+            percentile(result.m_sample, 0.5), percentile(result.m_sample, 0.9), percentile(result.m_sample, 0.99),
+            result.m_sample.empty() ? 0 : result.m_sample.back(), result.m_callAmount / result.m_totalSecond, mean(result.m_sample) / result.m_cellAmount,
+            static_cast<double>(result.m_heapAllocation) / std::max<size_t>(result.m_callAmount, 1));
+    }
+}
+
+int main (int argc, char **argv) {
+    BenchmarkContext context;
+    context.m_seed = 1;
+    context.m_sampleAmount = 2000;
+    bool isCsv = false;
+    // Every board size unless --rails picks one
+    std::vector<int> railAmountList = {ShippingBoard::railAmount, SixRailBoard::railAmount, EightRailBoard::railAmount, 32, 64, 128, 256};
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            isCsv = true;
+        } else if (strcmp(argv[i], "--rails") == 0 && i + 1 < argc) {
+            railAmountList = {atoi(argv[++i])};
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            context.m_seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            context.m_sampleAmount = std::max<size_t>(strtoull(argv[++i], nullptr, 10), 1);
+        }
+    }
+    context.m_nullSink = fopen(NULL_DEVICE, "wb");
+    if (!context.m_nullSink) {
+        fprintf(stderr, "Cannot open %s\n", NULL_DEVICE);
+        return 1;
+    }
+
+    for (int railAmount : railAmountList) {
+        context.m_railAmount = railAmount;
+        if (dispatchBoardSize<BenchmarkTask>(railAmount, &context) != 0) {
+            return 1;
+        }
+    }
+    printResult(&context, isCsv);
+
+    fclose(context.m_nullSink);
+    return 0;
+}
@@ -1,4 +1,5 @@
 g++ -save-temps=obj -o simulate.exe -std=c++11 simulate.cpp
+g++ -O2 -o benchmark.exe -std=c++11 benchmark.cpp
 
 :: use it on cmd to ensure colorful output
 :: reference from https://www.codeproject.com/Tips/5255355/How-to-Put-Color-on-Windows-Console
@@ -1,17 +1,43 @@
+// 64 bit off_t for fseeko() on 32 bit Unix, puzzle banks pass 2 GB
+#define _FILE_OFFSET_BITS 64
 #include <iostream>
 #include <cstdint>
 #include <cstdio>
 #include <cmath>
-#include <conio.h>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstring>
+#include <cstdarg>
+#include <string>
 #include <ctime>
 #include <bitset>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+#include <csignal>
+#include <deque>
+#include <functional>
+#include <new>
+#include <cstdlib>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #ifdef _WIN32
 #include <windows.h>
+#include <conio.h>
 #elif __unix__
 #include <unistd.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <pthread.h>
 #endif
 
 #define DEBUG_FLAG
@@ -34,6 +60,7 @@
 #define MAXIMUM_INTERLEAVE_TRACK_POS 2*MAXIMUM_TRACK_POS
 #define SLIDING_RAIL_AMOUNT 4
 #define TRACK_AMOUNT 5
+#define OFFSET_LEVEL_AMOUNT (MAXIMUM_BAR + 1) // quantized rail offset is 0 ~ MAXIMUM_BAR
 #define MAXIMUM_PHYSICAL_OFFSET_ON_RAIL 10.0f
 #define UNIT_PHYSICAL_OFFSET (MAXIMUM_PHYSICAL_OFFSET_ON_RAIL / MAXIMUM_BAR)
 #define RAIL_BAR_GENERATE_PROBABILITY 0.5f
@@ -61,6 +88,10 @@
   #define CHECKPOINT_AMOUNT 4
 #endif
 // #define MULTIPLE_SET_CHECKPOINT_GENERATION
+// #ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+//   // Checkpoints lie anywhere, an answer passes at least this many on the way to end track
+//   #define CHECKPOINT_AMOUNT 24
+// #endif
 
 // Progress bar generation
 #ifdef ONE_SET_CHECKPOINT_GENERATION
@@ -69,14 +100,68 @@
 #endif
 // #ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
 //   #define TO_MAXIMUM_CHECKPOINT_DISTANCE // proposed by Edge
-//   #ifdef TO_MAXIMUM_CHECKPOINT_DISTANCE
-//     #define MAXIMUM_FULFILL_CHECKPOINT 6
-//   #endif
 // #endif
 
+// Per-board table of end track, achieved checkpoint and completeness of every rail offset tuple,
+// rebuilt whenever checkpoints are regenerated
+#define OFFSET_LOOKUP_TABLE
+#ifdef OFFSET_LOOKUP_TABLE
+  // Fewest offset level steps from current rail offsets to a complete tuple, solved on a background thread from
+  // the lookup table of every checkpoint set, boards whose offset space is solved only
+  #define OFFSET_HINT
+#endif
+
+// Sensor input, fraction of a unit offset a position must pass a level boundary by, and samples in a row
+// the new level must hold before it's committed
+#define SENSOR_HYSTERESIS 0.25f
+#define SENSOR_DEBOUNCE_SAMPLE 4
+#define SENSOR_BATCH_CAPACITY 1024
+
+// Latency histograms, binary digits of precision kept within each power of two nanoseconds, latencies from
+// 2^LATENCY_MAXIMUM_EXPONENT ns (about 18 minutes) on fall in the last bucket
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_MAXIMUM_EXPONENT 40
+
+// Multi-session engine, sessions a worker task processes together, distinct boards sessions are dealt from, and
+// seconds and default per-session update rate of synthetic input when no endpoint is given
+#define SESSION_BLOCK_SIZE 256
+#define SESSION_BOARD_POOL_AMOUNT 64
+#define SESSION_LOAD_SECOND 5
+#define SESSION_UPDATE_RATE 10.0
+#define SESSION_INPUT_CAPACITY 4096
+
+// Difficulty analysis, tuples near an answer are counted up to NEAR_SOLUTION_DISTANCE steps from it and uniform
+// tuples are drawn per board whose offset space isn't solved, boards out of a difficulty band are regenerated at
+// most DIFFICULTY_BAND_DRAW_LIMIT times
+#define NEAR_SOLUTION_DISTANCE 3
+#define DIFFICULTY_SAMPLE_AMOUNT 4096
+#define DIFFICULTY_BAND_DRAW_LIMIT 256
+
+// Puzzle bank, difficulty buckets boards are split into by the fewest offset level steps to an answer
+#define PUZZLE_BANK_BUCKET_AMOUNT 4
+
+// Count heap allocations of each thread, batch simulation and benchmark report them once boards are reused. It
+// replaces global operator new, so it's off in the kiosk build, build batch runs with -DHEAP_ALLOCATION_COUNTER
+// #define HEAP_ALLOCATION_COUNTER
+
+// Wide board tracer uses AVX2 or SSE2 lanes when the compiler targets them, unless the portable loop is forced
+// #define SCALAR_TRACER
+
+// Random engine, xoshiro256** unless PCG is chosen
+// #define PCG_RANDOM_ENGINE
+// Bernoulli words draw probability with this many binary digits
+#define BERNOULLI_PRECISION_BITS 16
+
 // GUI related
 #define TRANSPOSE_GUI
 
+// Kiosk deployment, report CPU usage and game loop wakeups while the toy sits idle
+// #define IDLE_CPU_REPORT
+#ifdef IDLE_CPU_REPORT
+  // unit (second)
+  #define IDLE_CPU_REPORT_INTERVAL 60
+#endif
+
 
 // Functional macro
 // Generate 0000100000000000, 0100000000000000 and so on
@@ -87,63 +172,740 @@
 #define MASK_OUT_ALL_LOWER_BIT(n, b) ((n) & (~ALL_LOWER_BIT(b)))
 #define RIGHT_RAIL(i) (i)
 #define LEFT_RAIL(i) (i-1)
+#define LOWEST_BIT_INDEX(n) __builtin_ctzll(n)
+// Track lanes of the tracer, 4 bits per track
+#define TRACK_LANE_BITS 4
+#define TRACK_LANE(t) (0xFULL << ((t) * TRACK_LANE_BITS))
+#define REPEAT_LANE(v) (0x1111111111111111ULL * (v))
+#define BIT_COUNT(n) __builtin_popcountll(n)
+
+
+#ifdef HEAP_ALLOCATION_COUNTER
+// Global operator new is replaced to count allocations of the calling thread, array forms forward to it
+thread_local size_t heapAllocationAmount = 0;
+
+// Retry through the new handler as the standard operator new does, the handler either frees memory or throws
+void *retryHeapAllocation (size_t size) {
+    void *pointer = nullptr;
+    while (!pointer) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+        pointer = malloc(size ? size : 1);
+    }
+    return pointer;
+}
+
+void *operator new (size_t size) {
+    heapAllocationAmount++;
+    void *pointer = malloc(size ? size : 1);
+    return pointer ? pointer : retryHeapAllocation(size);
+}
+
+void operator delete (void *pointer) noexcept {
+    free(pointer);
+}
+#endif
+
+// Heap allocations made by the calling thread so far, 0 without the counter
+size_t threadHeapAllocation () {
+#ifdef HEAP_ALLOCATION_COUNTER
+    return heapAllocationAmount;
+#else
+    return 0;
+#endif
+}
+
+
+// Bit masks wider than 64 bits, bit i is bit (i % 64) of word i / 64
+template <int Bits>
+struct WideMask {
+    static constexpr int wordAmount = (Bits + 63) / 64;
+
+    uint64_t m_word[wordAmount];
+
+    WideMask() : m_word{} { }
+
+};
+
+template <int Bits>
+inline WideMask<Bits> operator& (const WideMask<Bits> &a, const WideMask<Bits> &b) {
+    WideMask<Bits> mask;
+    for (int i = 0; i < WideMask<Bits>::wordAmount; ++i) {
+        mask.m_word[i] = a.m_word[i] & b.m_word[i];
+    }
+    return mask;
+}
+
+// Bit helpers taking both plain integer masks and wide masks
+template <typename Mask>
+inline typename std::enable_if<std::is_integral<Mask>::value, bool>::type isMaskBitSet (Mask mask, int i) {
+    return (mask & MASK_AT(i)) ? true : false;
+}
+
+template <int Bits>
+inline bool isMaskBitSet (const WideMask<Bits> &mask, int i) {
+    return (mask.m_word[i / 64] & MASK_AT(i % 64)) ? true : false;
+}
+
+template <typename Mask>
+inline typename std::enable_if<std::is_integral<Mask>::value>::type setMaskBit (Mask *mask, int i) {
+    *mask = static_cast<Mask>(*mask | MASK_AT(i));
+}
+
+template <int Bits>
+inline void setMaskBit (WideMask<Bits> *mask, int i) {
+    mask->m_word[i / 64] |= MASK_AT(i % 64);
+}
+
+template <int Bits>
+inline void clearMaskBit (WideMask<Bits> *mask, int i) {
+    mask->m_word[i / 64] &= ~MASK_AT(i % 64);
+}
+
+template <typename Mask>
+inline typename std::enable_if<std::is_integral<Mask>::value, int>::type maskBitCount (Mask mask) {
+    return BIT_COUNT(mask);
+}
+
+template <int Bits>
+inline int maskBitCount (const WideMask<Bits> &mask) {
+    int bitCount = 0;
+    for (int i = 0; i < WideMask<Bits>::wordAmount; ++i) {
+        bitCount += BIT_COUNT(mask.m_word[i]);
+    }
+    return bitCount;
+}
+
+// Return -1 if no bit is set
+template <typename Mask>
+inline typename std::enable_if<std::is_integral<Mask>::value, int>::type lowestMaskBit (Mask mask) {
+    return mask ? LOWEST_BIT_INDEX(mask) : -1;
+}
+
+template <int Bits>
+inline int lowestMaskBit (const WideMask<Bits> &mask) {
+    for (int i = 0; i < WideMask<Bits>::wordAmount; ++i) {
+        if (mask.m_word[i]) {
+            return i * 64 + LOWEST_BIT_INDEX(mask.m_word[i]);
+        }
+    }
+    return -1;
+}
+
+// Call visit(i) for every set bit i in ascending order
+template <typename Mask, typename Visitor>
+inline typename std::enable_if<std::is_integral<Mask>::value>::type forEachMaskBit (Mask mask, Visitor visit) {
+    uint64_t bits = mask;
+    while (bits) {
+        visit(LOWEST_BIT_INDEX(bits));
+        bits &= bits - 1;
+    }
+}
+
+template <int Bits, typename Visitor>
+inline void forEachMaskBit (const WideMask<Bits> &mask, Visitor visit) {
+    for (int i = 0; i < WideMask<Bits>::wordAmount; ++i) {
+        uint64_t bits = mask.m_word[i];
+        while (bits) {
+            visit(i * 64 + LOWEST_BIT_INDEX(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+// Write bits into the 16 bits segment starting at bit 16 * segment, the segment must be clear
+template <typename Mask>
+inline typename std::enable_if<std::is_integral<Mask>::value>::type setMaskSegment (Mask *mask, int segment, uint16_t bits) {
+    *mask = static_cast<Mask>(*mask | (static_cast<uint64_t>(bits) << (16 * segment)));
+}
+
+template <int Bits>
+inline void setMaskSegment (WideMask<Bits> *mask, int segment, uint16_t bits) {
+    mask->m_word[segment / 4] |= static_cast<uint64_t>(bits) << (16 * (segment % 4));
+}
+
+// Bits [firstBit, firstBit + width) with width at most 16 and firstBit a multiple of width
+template <int Bits>
+inline uint32_t maskChunk (const WideMask<Bits> &mask, int firstBit, int width) {
+    return (mask.m_word[firstBit / 64] >> (firstBit % 64)) & ((1U << width) - 1);
+}
+
+// bitAmount characters, most significant first like std::bitset::to_string(), with bit i printed at i + shift
+template <typename Mask>
+std::string maskString (const Mask &mask, int bitAmount, int shift = 0) {
+    std::string text(bitAmount, '0');
+    forEachMaskBit(mask, [&] (int i) {
+        if (i + shift < bitAmount) {
+            text[bitAmount - 1 - (i + shift)] = '1';
+        }
+    });
+    return text;
+}
+
+// Track lanes of the wide tracer, 16 bits per track. Lane t sits at m_lane[laneBase + t] so a vector load one lane
+// before the first track or after the last one stays inside, lanes other than tracks hold NO_START_TRACK.
+#define NO_START_TRACK 0xFFFF
+template <int Tracks>
+struct WideOccupancy {
+    static constexpr int laneBase = 16;
+    static constexpr int laneAmount = (Tracks + 15) / 16 * 16; // tracks rounded up to whole vectors
+    static constexpr int laneStride = laneBase + laneAmount + 16;
+
+    uint16_t m_lane[laneStride];
+
+};
+
+// Amount of rail offset tuples, offsetLevelAmount^railAmount saturated at SIZE_MAX
+constexpr size_t offsetTupleAmount (int offsetLevelAmount, int railAmount) {
+    return railAmount == 0 ? 1 : (offsetTupleAmount(offsetLevelAmount, railAmount - 1) > SIZE_MAX / offsetLevelAmount ? SIZE_MAX :
+        offsetLevelAmount * offsetTupleAmount(offsetLevelAmount, railAmount - 1));
+}
+
+// Boards with at most this many offset tuples enumerate the whole offset space per board (solution set, lookup table),
+// larger ones draw advice offsets by rejection sampling and trace every input instead
+#define MAXIMUM_SOLVED_OFFSET_TUPLE (1 << 20)
+
+// Bars of one rail mask sampler draw, longer rails are joined from several draws
+#define RAIL_SEGMENT_BAR 16
+
+// Board dimensions, storage types and loop bounds are fixed at compile time per size, so one binary instantiates
+// several sizes and picks one at runtime. The macros above describe the shipping size, ShippingBoard. A board not
+// Solvable never enumerates its offset space even when it's small enough, see SampledBoard.
+template <int Rails, int Bars, int Checkpoints, bool Solvable = true>
+struct Board {
+    static constexpr int railAmount = Rails;
+    static constexpr int trackAmount = Rails + 1;
+    static constexpr int barAmount = Bars;
+    static constexpr int checkpointAmount = Checkpoints;
+    static constexpr int offsetLevelAmount = Bars + 1; // quantized rail offset is 0 ~ Bars
+    static constexpr int segmentBarAmount = Bars < RAIL_SEGMENT_BAR ? Bars : RAIL_SEGMENT_BAR;
+    static constexpr float unitPhysicalOffset = MAXIMUM_PHYSICAL_OFFSET_ON_RAIL / Bars;
+    static constexpr int trackPosAmount = 2 * Bars;
+    static constexpr int interleaveTrackPosAmount = 2 * trackPosAmount;
+    // checkpointAmount + 1, plus one is to prevent from choosing checkpoint at end point
+    static constexpr int checkpointSpacing = Checkpoints > 0 ? (interleaveTrackPosAmount - 1) / Checkpoints : interleaveTrackPosAmount;
+    static constexpr size_t offsetTupleAmount = ::offsetTupleAmount(Bars + 1, Rails);
+    static constexpr size_t offsetTupleWords = (offsetTupleAmount + 63) / 64;
+    // Packed tracer holds every track in a 4 bits lane of one word (lane 0xF marks an unused lane) and shifts
+    // a rail's bars by its offset in one word, larger boards use the wide tracer
+    static constexpr bool isWideBoard = !(trackAmount < 16 && trackAmount * TRACK_LANE_BITS <= 64 && Bars <= 16);
+    // End track and signature tracks are stored in 3 bits
+    static constexpr bool isOffsetSpaceSolved = Solvable && offsetTupleAmount <= MAXIMUM_SOLVED_OFFSET_TUPLE && trackAmount <= 8 && !isWideBoard;
+
+    // Smallest words holding a rail's bars and a track's interleaved positions
+    typedef typename std::conditional<Bars <= 8, uint8_t, typename std::conditional<Bars <= 16, uint16_t, WideMask<Bars> >::type>::type BarMask;
+    typedef typename std::conditional<interleaveTrackPosAmount <= 32, uint32_t,
+        typename std::conditional<interleaveTrackPosAmount <= 64, uint64_t, WideMask<interleaveTrackPosAmount> >::type>::type PositionMask;
+    // Tracer state of one position, packed lanes or wide lanes, and the pairs swapped on one position,
+    // lane mask of the lower tracks or a mask of the swapping rails
+    typedef typename std::conditional<isWideBoard, WideOccupancy<trackAmount>, uint64_t>::type Occupancy;
+    typedef typename std::conditional<isWideBoard, WideMask<trackAmount>, uint64_t>::type SwapLayer;
+
+    // Rails longer than a segment are joined from segments drawn by the rail mask sampler
+    static_assert(Bars <= RAIL_SEGMENT_BAR || Bars % RAIL_SEGMENT_BAR == 0, "Long rails must be whole segments");
+    static_assert(trackAmount < NO_START_TRACK, "Start tracks must fit in 16 bits lanes");
+};
+
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::railAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::trackAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::barAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::checkpointAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::offsetLevelAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::segmentBarAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr float Board<Rails, Bars, Checkpoints, Solvable>::unitPhysicalOffset;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::trackPosAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::interleaveTrackPosAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr int Board<Rails, Bars, Checkpoints, Solvable>::checkpointSpacing;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr size_t Board<Rails, Bars, Checkpoints, Solvable>::offsetTupleAmount;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr size_t Board<Rails, Bars, Checkpoints, Solvable>::offsetTupleWords;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr bool Board<Rails, Bars, Checkpoints, Solvable>::isWideBoard;
+template <int Rails, int Bars, int Checkpoints, bool Solvable> constexpr bool Board<Rails, Bars, Checkpoints, Solvable>::isOffsetSpaceSolved;
+
+typedef Board<SLIDING_RAIL_AMOUNT, MAXIMUM_BAR, CHECKPOINT_AMOUNT> ShippingBoard;
+
+static_assert(ShippingBoard::trackAmount == TRACK_AMOUNT, "TRACK_AMOUNT must be SLIDING_RAIL_AMOUNT + 1");
+
+// Board sizes besides ShippingBoard, picked at runtime by --rails. Their offset spaces are too large to solve.
+typedef Board<6, MAXIMUM_BAR, ShippingBoard::checkpointAmount> SixRailBoard;
+typedef Board<8, MAXIMUM_BAR, ShippingBoard::checkpointAmount> EightRailBoard;
+// Large-format and stress boards, as many bars per rail as rails, traced by the wide tracer
+template <int Rails>
+using LargeBoard = Board<Rails, Rails, ShippingBoard::checkpointAmount>;
+
+// Same size drawing advice offsets by rejection sampling and tracing every input like boards too large to solve,
+// for batch runs needing boards faster than a whole offset space per board allows
+template <typename Board>
+using SampledBoard = typename std::conditional<Board::isOffsetSpaceSolved,
+    ::Board<Board::railAmount, Board::barAmount, Board::checkpointAmount, false>, Board>::type;
+
+// Run Task<Board>::run() on the board size with railAmount rails
+template <template <typename> class Task, typename... Argument>
+int dispatchBoardSize (int railAmount, Argument... argument) {
+    switch (railAmount) {
+        case ShippingBoard::railAmount:
+            return Task<ShippingBoard>::run(argument...);
+        case SixRailBoard::railAmount:
+            return Task<SixRailBoard>::run(argument...);
+        case EightRailBoard::railAmount:
+            return Task<EightRailBoard>::run(argument...);
+        case LargeBoard<32>::railAmount:
+            return Task<LargeBoard<32> >::run(argument...);
+        case LargeBoard<64>::railAmount:
+            return Task<LargeBoard<64> >::run(argument...);
+        case LargeBoard<128>::railAmount:
+            return Task<LargeBoard<128> >::run(argument...);
+        case LargeBoard<256>::railAmount:
+            return Task<LargeBoard<256> >::run(argument...);
+    }
+    fprintf(stderr, "Unsupported rail amount %d, choose 4, 6, 8, 32, 64, 128 or 256\n", railAmount);
+    return 1;
+}
+
+#ifdef OFFSET_LOOKUP_TABLE
+// Lookup entry layout: end track (3 bits) | achieved checkpoint (4 bits, saturated) | is complete (1 bit)
+  #define LOOKUP_ENTRY(endTrack, achievedCheckpoint, isComplete) static_cast<uint8_t>((endTrack) | (std::min((achievedCheckpoint), 15) << 3) | ((isComplete) ? 0x80 : 0))
+  #define LOOKUP_END_TRACK(e) ((e) & 0x7)
+  #define LOOKUP_ACHIEVED_CHECKPOINT(e) (((e) >> 3) & 0xF)
+  #define LOOKUP_IS_COMPLETE(e) (((e) & 0x80) ? true : false)
+
+  #ifdef ONE_SET_CHECKPOINT_GENERATION
+// One set checkpoints only lie on multiples of checkpoint spacing, so the tracks a tuple passes there and its end track
+// (3 bits each, end track last) decide its lookup entry under any regenerated checkpoints
+    #define OFFSET_SIGNATURE
+    #define SIGNATURE_TRACK(s, k) (((s) >> (3 * (k))) & 0x7)
+  #endif
+#endif
 
-typedef struct RailStatus {
-    uint16_t m_activeBar;
+template <typename Board>
+struct RailStatus {
+    typename Board::BarMask m_activeBar;
 
     size_t m_offset;
 
     size_t m_adviceCompleteOffset; // Pre-compute advice rail offset
 
-    RailStatus() : m_activeBar(0), m_offset(0) { }
+    RailStatus() : m_activeBar(), m_offset(0), m_adviceCompleteOffset(0) { }
 
-} RailStatus;
+};
 
-typedef struct TrackStatus {
-    uint64_t m_checkpoint;
+template <typename Board>
+struct TrackStatus {
+    typename Board::PositionMask m_checkpoint;
 
 #ifdef CHECKPOINT_TRIGGER_EVENT
-    uint64_t m_triggerCheckpoint;
+    typename Board::PositionMask m_triggerCheckpoint;
+#endif
+
+    TrackStatus() : m_checkpoint() { }
+
+};
+
+template <typename Board>
+struct GhostLegTrace {
+    // Lane t holds the start track currently on track t, the entry i is taken before the swaps on interleaved position i
+    // and the last entry is the state after the whole board
+    typename Board::Occupancy m_occupancy[Board::interleaveTrackPosAmount + 1];
+
+};
+
+// Per-board tables over the whole offset space, empty when the board is too large to enumerate
+template <typename Board, bool IsOffsetSpaceSolved = Board::isOffsetSpaceSolved>
+struct OffsetSpaceTable {
+    // Every offset tuple leading start track to end track, indexed by encodeOffsetTuple()
+    uint64_t m_solutionSet[Board::offsetTupleWords];
+
+#ifdef OFFSET_SIGNATURE
+    uint16_t m_offsetSignature[Board::offsetTupleAmount];
+
+    static_assert(3 * (Board::checkpointAmount + 1) <= 16, "Offset signature must fit in 16 bits");
+#endif
+
+#ifdef OFFSET_LOOKUP_TABLE
+    uint8_t m_offsetLookupTable[Board::offsetTupleAmount];
+
+    static constexpr size_t lookupTableSize = sizeof(uint8_t) * Board::offsetTupleAmount;
 #endif
 
-    TrackStatus() : m_checkpoint(0) { }
+};
 
-} TrackStatus;
+template <typename Board>
+struct OffsetSpaceTable<Board, false> {
+    static constexpr size_t lookupTableSize = 0;
+};
 
-typedef struct GameStatus {
-    RailStatus *m_railStatusList;
+template <typename Board>
+struct GameStatus {
+    // Rails and tracks are owned inline, regenerateGame() reuses them for the next board
+    RailStatus<Board> m_railStatusList[Board::railAmount];
 
-    TrackStatus *m_trackStatusList;
+    TrackStatus<Board> m_trackStatusList[Board::trackAmount];
 
     size_t m_startTrack;
 
     size_t m_endTrack;
 
-    int m_adviceAnswerTrackPath[64];
+    int m_adviceAnswerTrackPath[Board::interleaveTrackPosAmount];
+
+    // Generation statistic, rail draws of generateGhostLegGraph() and boards dropped for having no answer
+    int m_railRegenerateTime;
+    int m_unsolvableRegenerateTime;
+
+    OffsetSpaceTable<Board> m_offsetSpace;
+
+    // Size of solution set, 0 if the offset space isn't solved
+    size_t m_solutionAmount;
+
+    // Tuples traced by rejection sampling in findAdmissibleAnswer() when the offset space isn't solved
+    size_t m_adviceDrawAmount;
+
+#ifdef OFFSET_LOOKUP_TABLE
+    // Amount of tuples completing the game under current checkpoints
+    size_t m_lookupSolutionAmount;
+
+    // Tuple of last lookup, offsetTupleAmount if there is none
+    size_t m_lookupTuple;
+
+    double m_lookupBuildTime; // unit (second)
+
+    // Complete tuples in the puzzle bank record of a board dealt from the bank, which has no offset space tables
+    // until checkpoints are regenerated, nullptr otherwise
+    const uint64_t *m_bankCompleteSet;
+#endif
 
     int m_achievedCheckpoint;
 
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    // Most checkpoints an answer passes, exact when the lookup table is built, otherwise those on advice path
+    int m_maximumCheckpoint;
+
+    // Checkpoint sets without any answer, repaired along advice path, and time to draw, check and repair last set
+    int m_checkpointRepairTime;
+    double m_checkpointGenerateTime; // unit (second)
+#endif
+
 #ifdef CHECKPOINT_TRIGGER_EVENT
     bool m_isTriggerCheckpoint;
+
+    // Rising edge of m_isTriggerCheckpoint is already scheduled
+    bool m_isTriggerCheckpointScheduled;
 #endif
 
     bool m_isComplete;
 
     float m_progressBar;
 
+    // Trace, track history and progress bar lag behind a table lookup until refreshGameProgress()
+    bool m_isProgressStale;
+
+    // Swap layers and trace of current rail offsets, refreshed by updateCurrentTrace()
+    typename Board::SwapLayer m_swapLayer[Board::interleaveTrackPosAmount];
+
+    GhostLegTrace<Board> m_currentTrace;
+
+    // Swap layers and trace of advice rail offsets, wide ones are too large for the stack
+    typename Board::SwapLayer m_adviceSwapLayer[Board::interleaveTrackPosAmount];
+
+    GhostLegTrace<Board> m_adviceTrace;
+
+    // Prefix cache of current trace, entry i is accumulated before position i
+    int m_achievedCheckpointPrefix[Board::interleaveTrackPosAmount + 1];
+
+#ifdef ONE_SET_CHECKPOINT_GENERATION
+    // Distance field of current checkpoints, entry [p][t] is the distance of entering position p on track t,
+    // built by updateDistanceField()
+    uint16_t m_checkpointDistance[Board::interleaveTrackPosAmount + 1][Board::trackAmount];
+    uint16_t m_endTrackDistance[Board::interleaveTrackPosAmount + 1][Board::trackAmount];
+
+    // Active bars of each rail below bar i, scratch of updateDistanceField() too large for the stack
+    uint16_t m_barPrefix[Board::railAmount][Board::barAmount + 1];
+#endif
+#ifdef CHECKPOINT_TRIGGER_EVENT
+    bool m_isTriggerCheckpointPrefix[Board::interleaveTrackPosAmount + 1];
+#endif
+
+    // Rail offsets the swap layers and trace are built with
+    size_t m_tracedOffset[Board::railAmount];
+
+    // False forces a full re-trace, e.g. after checkpoints change
+    bool m_isTraceValid;
+
+    // Positions re-traced by last update and in total
+    size_t m_retracedPosition;
+    size_t m_retracedPositionTotal;
+    size_t m_traceUpdateAmount;
+
     // For debug purpose
     float m_debug;
     int m_currentEndTrack;
-    int m_currentTrackHistory[64];
+    int m_currentTrackHistory[Board::interleaveTrackPosAmount];
 
-} GameStatus;
+};
 
-typedef struct InputStatus {
-    float m_physicalOffset[SLIDING_RAIL_AMOUNT];
+template <typename Board>
+struct InputStatus {
+    float m_physicalOffset[Board::railAmount];
 
     InputStatus() : m_physicalOffset{} { }
 
-} InputStatus;
+};
+
+enum GameEventType {
+    INPUT_EVENT = 1 << 0,
+    TIMER_EVENT = 1 << 1, // timer deadline reached
+    CHECKPOINT_EVENT = 1 << 2, // checkpoint regenerated
+    REDRAW_EVENT = 1 << 3,
+    REFRESH_EVENT = 1 << 4, // redraw whole screen
+    LATENCY_REPORT_EVENT = 1 << 5, // export latency histograms
+    QUIT_EVENT = 1 << 6, // interrupted, leave GUI loop as if the game was over
+    HINT_EVENT = 1 << 7 // hint table of latest checkpoints solved
+};
+
+template <typename Board>
+struct GameEventQueue {
+    std::mutex m_mutex;
+
+    std::condition_variable m_condition;
+
+    uint32_t m_pendingEvent;
+
+    // Times a waiting thread is woken up with event
+    size_t m_wakeupAmount;
+
+    // Latest input handed from input thread to game loop along with INPUT_EVENT
+    InputStatus<Board> m_inputStatus;
+
+    int m_currentInputRail;
+
+    // When the oldest input not taken by game loop yet was posted, later inputs overwrite the status but the
+    // player has been waiting since this one
+    std::chrono::steady_clock::time_point m_inputTime;
+
+    bool m_hasInputTime;
+
+    GameEventQueue() : m_pendingEvent(0), m_wakeupAmount(0), m_currentInputRail(0), m_hasInputTime(false) { }
+
+};
+
+enum TimerType {
+    TIME_TRIGGER_TIMER,
+    CHECKPOINT_TRIGGER_TIMER,
+    IDLE_REPORT_TIMER, // redraw only, checkpoints stay
+    TIMER_TYPE_AMOUNT
+};
+
+typedef struct TimerEntry {
+    std::chrono::steady_clock::time_point m_deadline;
+
+    // Zero for one shot timer
+    std::chrono::steady_clock::duration m_interval;
+
+    TimerType m_type;
+
+} TimerEntry;
+
+typedef struct TimerScheduler {
+    // Min heap on m_deadline
+    std::vector<TimerEntry> m_timerHeap;
+
+    size_t m_firedAmount[TIMER_TYPE_AMOUNT];
+
+    TimerScheduler() : m_firedAmount{} { }
+
+} TimerScheduler;
+
+// Timestamps an input event collects on its way to the screen
+enum LatencyPoint {
+    INPUT_POSTED_POINT,
+    INPUT_TAKEN_POINT,
+    RAIL_UPDATED_POINT,
+    GAME_UPDATED_POINT, // updateGameInfo() and progressBarUpdate() decided completion
+    FRAME_PUBLISHED_POINT,
+    FRAME_FLUSHED_POINT,
+    LATENCY_POINT_AMOUNT
+};
+
+enum LatencyStage {
+    INPUT_QUEUE_STAGE,
+    RAIL_INPUT_UPDATE_STAGE,
+    UPDATE_GAME_INFO_STAGE,
+    PUBLISH_FRAME_STAGE,
+    FLUSH_FRAME_STAGE,
+    INPUT_TO_DECISION_STAGE,
+    INPUT_TO_FLUSH_STAGE,
+    LATENCY_STAGE_AMOUNT
+};
+
+#define LATENCY_SUB_BUCKET_AMOUNT (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKET_AMOUNT ((LATENCY_MAXIMUM_EXPONENT - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKET_AMOUNT)
+
+// Log-linear buckets as HDR histograms use, each power of two nanoseconds is split into LATENCY_SUB_BUCKET_AMOUNT
+// equal buckets so the relative error stays under 1 / LATENCY_SUB_BUCKET_AMOUNT. Any thread records without locks.
+typedef struct LatencyHistogram {
+    std::atomic<uint64_t> m_bucket[LATENCY_BUCKET_AMOUNT];
+
+    std::atomic<uint64_t> m_count;
+
+    // unit (ns)
+    std::atomic<uint64_t> m_sum;
+
+    std::atomic<uint64_t> m_maximum;
+
+    LatencyHistogram() : m_count(0), m_sum(0), m_maximum(0) {
+        for (int i = 0; i < LATENCY_BUCKET_AMOUNT; ++i) {
+            m_bucket[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+} LatencyHistogram;
+
+typedef struct LatencyRecorder {
+    LatencyHistogram m_stage[LATENCY_STAGE_AMOUNT];
+} LatencyRecorder;
+
+#ifdef OFFSET_HINT
+#define HINT_UNREACHABLE UINT8_MAX
+
+typedef struct OffsetHint {
+    // Steps to the nearest complete tuple, 0 if current tuple is complete, HINT_UNREACHABLE if the hint
+    // of current checkpoints isn't solved yet
+    int m_distance;
+
+    // Rail to move and offset levels to move it by, positive is up, -1 and 0 if there is no move
+    int m_rail;
+    int m_step;
+
+} OffsetHint;
+
+// Steps of every offset tuple to the nearest complete tuple under one checkpoint set, a step moves one rail by
+// one offset level, indexed by encodeOffsetTuple()
+template <typename Board>
+struct HintTable {
+    uint8_t m_distance[Board::offsetTupleAmount];
+
+    // Request the table is solved for, 0 if none
+    uint64_t m_generation;
+
+    double m_solveTime; // unit (second)
+
+};
+
+// Solver thread takes the complete tuples of the latest request and solves the back table, game loop reads the
+// front table, they swap through the middle slot as FrameBuffer does
+template <typename Board, bool IsOffsetSpaceSolved = Board::isOffsetSpaceSolved>
+struct HintSolver {
+    HintTable<Board> m_table[3];
+
+    // Slot between solver thread and game loop, FRESH_FRAME_BIT marks it is not consumed yet
+    std::atomic<uint8_t> m_middle;
+
+    // Solver thread only
+    uint8_t m_back;
+
+    // Game loop only, m_generation is the latest request posted
+    uint8_t m_front;
+    uint64_t m_generation;
+
+    std::mutex m_mutex;
+
+    std::condition_variable m_condition;
+
+    // Complete tuples of latest request, bit per tuple as m_solutionSet, guarded by m_mutex
+    uint64_t m_completeSet[Board::offsetTupleWords];
+
+    uint64_t m_requestGeneration;
+
+    HintSolver() : m_table{}, m_middle(1), m_back(0), m_front(2), m_generation(0), m_completeSet{}, m_requestGeneration(0) { }
+
+};
+
+template <typename Board>
+struct HintSolver<Board, false> {
+};
+#endif
+
+// Immutable copy of everything GUI and telemetry read, published by game loop
+template <typename Board>
+struct GameFrame {
+    // Publish sequence number
+    uint64_t m_version;
+
+    RailStatus<Board> m_railStatusList[Board::railAmount];
+
+    TrackStatus<Board> m_trackStatusList[Board::trackAmount];
+
+    size_t m_startTrack;
+
+    size_t m_endTrack;
+
+    int m_adviceAnswerTrackPath[Board::interleaveTrackPosAmount];
+
+    int m_achievedCheckpoint;
+
+    bool m_isComplete;
+
+    float m_progressBar;
+
+    InputStatus<Board> m_inputStatus;
+
+    int m_currentInputRail;
+
+    // For debug purpose
+    float m_debug;
+    int m_currentEndTrack;
+    int m_currentTrackHistory[Board::interleaveTrackPosAmount];
+    size_t m_retracedPosition;
+    double m_averageRetracedPosition;
+#ifdef OFFSET_LOOKUP_TABLE
+    size_t m_lookupTableSize;
+    size_t m_lookupSolutionAmount;
+    double m_lookupBuildTime;
+#endif
+    size_t m_firedAmount[TIMER_TYPE_AMOUNT];
+
+#ifdef OFFSET_HINT
+    OffsetHint m_hint;
+#endif
+
+    // Points up to FRAME_PUBLISHED_POINT of the input the frame answers, set by game loop when m_hasInputLatency
+    std::chrono::steady_clock::time_point m_latencyPoint[LATENCY_POINT_AMOUNT];
+
+    bool m_hasInputLatency;
+
+    // gameStateDigest() of the board, set by game loop only while a trace is recorded
+    uint64_t m_stateDigest;
+
+};
+
+#define FRESH_FRAME_BIT 0x4
+#define FRAME_SLOT_MASK 0x3
+
+// Triple buffer, writer fills back slot and swaps it with middle slot, reader swaps front slot with
+// middle slot when it is fresh. Neither side waits for the other and a slot is never shared.
+template <typename Board>
+struct FrameBuffer {
+    GameFrame<Board> m_frame[3];
+
+    // Slot between writer and reader, FRESH_FRAME_BIT marks it is not consumed yet
+    std::atomic<uint8_t> m_middle;
+
+    // Writer only
+    uint8_t m_back;
+    uint64_t m_version;
+
+    // Reader only
+    uint8_t m_front;
+
+    std::atomic<size_t> m_publishAmount;
+    std::atomic<size_t> m_consumeAmount;
+    // Published frames replaced before reader consumed them
+    std::atomic<size_t> m_droppedAmount;
+
+    FrameBuffer() : m_frame{}, m_middle(1), m_back(0), m_version(0), m_front(2), m_publishAmount(0), m_consumeAmount(0), m_droppedAmount(0) { }
+
+};
 
 typedef struct GraphProperty {
     enum struct GraphIcon {
@@ -153,7 +915,7 @@ typedef struct GraphProperty {
     };
     GraphIcon m_content;
 
-    enum struct GraphColor {
+    enum struct GraphColor : uint8_t {
         WHITE,
         RED,
         GREEN,
@@ -168,672 +930,4870 @@ typedef struct GraphProperty {
 
     GraphProperty (GraphIcon icon, GraphColor color) : m_content(icon), m_color(color) { }
 
-    static void printColor(GraphColor color) {
+    static const char *colorCode(GraphColor color) {
         if (color == GraphColor::WHITE) {
-            printf(WHITE_COLOR);
+            return WHITE_COLOR;
         } else if (color == GraphColor::RED) {
-            printf(RED_COLOR);
+            return RED_COLOR;
         } else if (color == GraphColor::GREEN) {
-            printf(GREEN_COLOR);
+            return GREEN_COLOR;
         } else if (color == GraphColor::BLUE) {
-            printf(BLUE_COLOR);
+            return BLUE_COLOR;
         } else if (color == GraphColor::YELLOW) {
-            printf(YELLOW_COLOR);
-        } else if (color == GraphColor::DEFAULT) {
-            printf(DEFAULT_COLOR);
+            return YELLOW_COLOR;
         }
+        return DEFAULT_COLOR;
     }
 
-    void print (bool isTranspose) {
-        printColor(m_color);
+    char glyph (bool isTranspose) const {
         if(m_content == GraphIcon::SPACE) {
-            printf(" ");
-            return;
+            return ' ';
         }
         if(m_content == GraphIcon::BAR) {
-            printf(isTranspose?"-":"|");
+            return isTranspose?'-':'|';
         } else {
-            printf(isTranspose?"|":"-");
+            return isTranspose?'|':'-';
         }
-        printColor(GraphColor::DEFAULT);
     }
 
 } GraphProperty;
 
-// utility
-static float seed = time(nullptr);
+#define SCREEN_ROW_AMOUNT 128
+#define SCREEN_COLUMN_AMOUNT 160
 
-float randomFloat () {
-    seed -= rand();
-    return fabs(modf(sin(seed * 12.9898) * 43758.5453, nullptr));
-}
+typedef struct ScreenCell {
+    char m_glyph;
 
-float clamp (float value, float min, float max) {
-    return value < min ? min : ((value > max) ? max : value);
-}
+    GraphProperty::GraphColor m_color;
 
-time_t getCurrentTimeInSecond () {
-    time_t rawtime;
-    time(&rawtime);
-    return rawtime;
-}
+    bool operator!= (const ScreenCell &cell) const {
+        return m_glyph != cell.m_glyph || m_color != cell.m_color;
+    }
 
-double getDiffSecond (time_t begin, time_t end) {
-  return difftime(end, begin);
-}
+} ScreenCell;
 
-bool isRailInBoundary (int currentRail) {
-    return currentRail >= 0 ? (currentRail < SLIDING_RAIL_AMOUNT? true: false): false;
-}
+// Frame composed in memory and diffed against what terminal shows, only changed cells are written
+typedef struct ScreenBuffer {
+    ScreenCell m_cell[SCREEN_ROW_AMOUNT][SCREEN_COLUMN_AMOUNT];
 
-float coherenceBetweenBar (const RailStatus *rail) {
-   float cumulatedCoherence = .0f;
-   int prevActiveBar = INVALID_BAR_INDEX;
-   for (int i = 0; i < MAXIMUM_BAR; ++i) {
-      if (rail->m_activeBar & MASK_AT(i)) {
-          // Calculate current active bar and previous detected active bar's distance, get its reciprocal
-          if (prevActiveBar != INVALID_BAR_INDEX) {
-              cumulatedCoherence += 1.0f / static_cast<float>(i - prevActiveBar);
-          }
-          prevActiveBar = i;
-      }
-   }
-   return prevActiveBar==INVALID_BAR_INDEX ? INFINITY_COHERENCE : cumulatedCoherence;
-}
+    // What terminal currently shows
+    ScreenCell m_shownCell[SCREEN_ROW_AMOUNT][SCREEN_COLUMN_AMOUNT];
 
-// Input update
-void railInputMapping (float physicalOffsetOnRailTrack, RailStatus *rail) {
+    // False forces clearing terminal and drawing every cell
+    bool m_isShown;
+
+    // Text cursor of screenPrintf()
+    int m_cursorRow;
+    int m_cursorColumn;
+
+    // Rows used by current and last frame
+    int m_usedRow;
+    int m_shownUsedRow;
+
+    std::string m_output;
+
+    size_t m_frameByte;
+    size_t m_totalByte;
+    size_t m_frameAmount;
+
+    ScreenBuffer() : m_isShown(false), m_cursorRow(0), m_cursorColumn(0), m_usedRow(0), m_shownUsedRow(0), m_frameByte(0), m_totalByte(0), m_frameAmount(0) { }
+
+} ScreenBuffer;
+
+// Random engine state, owned by whoever generates (a game loop, a batch worker), never shared between threads
+typedef struct RandomEngine {
+#ifdef PCG_RANDOM_ENGINE
+    uint64_t m_state;
+    uint64_t m_increment;
+#else
+    uint64_t m_state[4];
+#endif
+} RandomEngine;
+
+// One column of the alias table, draw keeps m_mask when the low 32 bits of the draw are under m_threshold
+typedef struct RailMaskAlias {
+    uint16_t m_mask;
+    uint16_t m_aliasMask;
+    uint32_t m_threshold;
+} RailMaskAlias;
+
+// Bernoulli(RAIL_BAR_GENERATE_PROBABILITY) bar masks conditioned on coherence under MAXIMUM_COHERENCE,
+// built once per board size from all 2^barAmount masks
+typedef struct RailMaskSampler {
+    std::vector<RailMaskAlias> m_alias;
+
+    // Chance a Bernoulli drawn mask is valid, the retry loop took 1 / m_validProbability draws per rail
+    double m_validProbability;
+
+    RailMaskSampler() : m_validProbability(0) { }
+
+} RailMaskSampler;
+
+// utility
+uint64_t splitMix64 (uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Same seed gives same sequence on every platform
+void seedRandomEngine (RandomEngine *engine, uint64_t seed) {
+#ifdef PCG_RANDOM_ENGINE
+    engine->m_state = splitMix64(&seed);
+    engine->m_increment = splitMix64(&seed) | 1;
+#else
+    // splitmix64 never yields an all zero xoshiro state
+    for (int i = 0; i < 4; ++i) {
+        engine->m_state[i] = splitMix64(&seed);
+    }
+#endif
+}
+
+#ifdef PCG_RANDOM_ENGINE
+uint32_t nextRandom32 (RandomEngine *engine) {
+    // PCG-XSH-RR
+    uint64_t state = engine->m_state;
+    engine->m_state = state * 6364136223846793005ULL + engine->m_increment;
+    uint32_t xorShifted = static_cast<uint32_t>(((state >> 18) ^ state) >> 27);
+    uint32_t rotate = static_cast<uint32_t>(state >> 59);
+    return (xorShifted >> rotate) | (xorShifted << ((-rotate) & 31));
+}
+
+uint64_t nextRandom (RandomEngine *engine) {
+    uint64_t high = nextRandom32(engine);
+    return (high << 32) | nextRandom32(engine);
+}
+#else
+uint64_t rotateLeft (uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t nextRandom (RandomEngine *engine) {
+    // xoshiro256**
+    uint64_t *s = engine->m_state;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+#endif
+
+// Uniform in [0, 1)
+float randomFloat (RandomEngine *engine) {
+    return (nextRandom(engine) >> 40) * (1.0f / (1 << 24));
+}
+
+// Uniform in [0, n), n should be under 2^32
+size_t randomBelow (RandomEngine *engine, size_t n) {
+    return static_cast<size_t>(((nextRandom(engine) >> 32) * n) >> 32);
+}
+
+// 64 independent bits, each set with probability p (rounded to BERNOULLI_PRECISION_BITS binary digits).
+// Walking the binary digits of p from the lowest set one, a set digit ORs in a random word and a clear digit
+// ANDs one, so p = 0.5 costs one word and p = 0.3 costs 15 instead of 64 draws.
+uint64_t randomBernoulliWord (RandomEngine *engine, float p) {
+    const uint32_t one = 1U << BERNOULLI_PRECISION_BITS;
+    if (p <= 0) {
+        return 0;
+    }
+    uint32_t fixedP = static_cast<uint32_t>(std::min(p, 1.0f) * one + 0.5f);
+    if (fixedP == 0) {
+        return 0;
+    }
+    if (fixedP >= one) {
+        return ~0ULL;
+    }
+    uint64_t word = 0;
+    for (int i = LOWEST_BIT_INDEX(fixedP); i < BERNOULLI_PRECISION_BITS; ++i) {
+        word = (fixedP & MASK_AT(i)) ? (word | nextRandom(engine)) : (word & nextRandom(engine));
+    }
+    return word;
+}
+
+// Mask of independent bits set with probability p, one word drawn per 64 bits
+template <typename Mask>
+typename std::enable_if<std::is_integral<Mask>::value, Mask>::type randomBernoulliMask (RandomEngine *engine, float p) {
+    return static_cast<Mask>(randomBernoulliWord(engine, p));
+}
+
+template <typename Mask>
+typename std::enable_if<!std::is_integral<Mask>::value, Mask>::type randomBernoulliMask (RandomEngine *engine, float p) {
+    Mask mask;
+    for (int i = 0; i < Mask::wordAmount; ++i) {
+        mask.m_word[i] = randomBernoulliWord(engine, p);
+    }
+    return mask;
+}
+
+float clamp (float value, float min, float max) {
+    return value < min ? min : ((value > max) ? max : value);
+}
+
+time_t getCurrentTimeInSecond () {
+    time_t rawtime;
+    time(&rawtime);
+    return rawtime;
+}
+
+double getDiffSecond (time_t begin, time_t end) {
+  return difftime(end, begin);
+}
+
+double getProcessCpuSecond () {
+#ifdef _WIN32
+    FILETIME createTime, exitTime, kernelTime, userTime;
+    GetProcessTimes(GetCurrentProcess(), &createTime, &exitTime, &kernelTime, &userTime);
+    // FILETIME is in 100 nanoseconds
+    uint64_t kernel = (static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+    uint64_t user = (static_cast<uint64_t>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+    return (kernel + user) * 1e-7;
+#elif __unix__
+    timespec cpuTime;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuTime);
+    return cpuTime.tv_sec + cpuTime.tv_nsec * 1e-9;
+#endif
+}
+
+// Event
+template <typename Board>
+void postGameEvent (GameEventQueue<Board> *queue, uint32_t event) {
+    {
+        std::lock_guard<std::mutex> lock(queue->m_mutex);
+        queue->m_pendingEvent |= event;
+    }
+    queue->m_condition.notify_all();
+}
+
+template <typename Board>
+void postInputEvent (GameEventQueue<Board> *queue, const InputStatus<Board> *inputStatus, int currentInputRail) {
+    {
+        std::lock_guard<std::mutex> lock(queue->m_mutex);
+        queue->m_inputStatus = *inputStatus;
+        queue->m_currentInputRail = currentInputRail;
+        queue->m_pendingEvent |= INPUT_EVENT;
+        if (!queue->m_hasInputTime) {
+            queue->m_inputTime = std::chrono::steady_clock::now();
+            queue->m_hasInputTime = true;
+        }
+    }
+    queue->m_condition.notify_all();
+}
+
+// inputTime is when the oldest input folded into inputStatus was posted
+template <typename Board>
+void takeInput (GameEventQueue<Board> *queue, InputStatus<Board> *inputStatus, int *currentInputRail, std::chrono::steady_clock::time_point *inputTime) {
+    std::lock_guard<std::mutex> lock(queue->m_mutex);
+    *inputStatus = queue->m_inputStatus;
+    *currentInputRail = queue->m_currentInputRail;
+    *inputTime = queue->m_hasInputTime ? queue->m_inputTime : std::chrono::steady_clock::now();
+    queue->m_hasInputTime = false;
+}
+
+// Block until any event in eventMask is posted, then consume and return them
+template <typename Board>
+uint32_t waitGameEvent (GameEventQueue<Board> *queue, uint32_t eventMask) {
+    std::unique_lock<std::mutex> lock(queue->m_mutex);
+    queue->m_condition.wait(lock, [&] () { return (queue->m_pendingEvent & eventMask) != 0; });
+    uint32_t event = queue->m_pendingEvent & eventMask;
+    queue->m_pendingEvent &= ~eventMask;
+    queue->m_wakeupAmount++;
+    return event;
+}
+
+// Same as waitGameEvent() but give up at deadline and return TIMER_EVENT
+template <typename Board>
+uint32_t waitGameEventUntil (GameEventQueue<Board> *queue, uint32_t eventMask, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(queue->m_mutex);
+    queue->m_condition.wait_until(lock, deadline, [&] () { return (queue->m_pendingEvent & eventMask) != 0; });
+    uint32_t event = queue->m_pendingEvent & eventMask;
+    queue->m_pendingEvent &= ~eventMask;
+    queue->m_wakeupAmount++;
+    return event ? event : static_cast<uint32_t>(TIMER_EVENT);
+}
+
+// Timer
+bool isTimerEarlier (const TimerEntry &a, const TimerEntry &b) {
+    return a.m_deadline > b.m_deadline;
+}
+
+void scheduleTimer (TimerScheduler *scheduler, TimerType type, std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration interval) {
+    TimerEntry timer;
+    timer.m_deadline = deadline;
+    timer.m_interval = interval;
+    timer.m_type = type;
+    scheduler->m_timerHeap.push_back(timer);
+    std::push_heap(scheduler->m_timerHeap.begin(), scheduler->m_timerHeap.end(), isTimerEarlier);
+}
+
+bool hasTimer (const TimerScheduler *scheduler) {
+    return !scheduler->m_timerHeap.empty();
+}
+
+// NOTICE: make sure hasTimer() first
+std::chrono::steady_clock::time_point nextTimerDeadline (const TimerScheduler *scheduler) {
+    return scheduler->m_timerHeap.front().m_deadline;
+}
+
+// Pop one timer expired at now, periodic timer is re-armed at its next deadline after now, so
+// a timer fires exactly once per deadline and missed periods are not fired in burst
+bool popExpiredTimer (TimerScheduler *scheduler, std::chrono::steady_clock::time_point now, TimerType *type) {
+    if (!hasTimer(scheduler) || nextTimerDeadline(scheduler) > now) {
+        return false;
+    }
+    std::pop_heap(scheduler->m_timerHeap.begin(), scheduler->m_timerHeap.end(), isTimerEarlier);
+    TimerEntry timer = scheduler->m_timerHeap.back();
+    scheduler->m_timerHeap.pop_back();
+    *type = timer.m_type;
+    scheduler->m_firedAmount[timer.m_type]++;
+    if (timer.m_interval.count() > 0) {
+        do {
+            timer.m_deadline += timer.m_interval;
+        } while (timer.m_deadline <= now);
+        scheduleTimer(scheduler, timer.m_type, timer.m_deadline, timer.m_interval);
+    }
+    return true;
+}
+
+template <typename Board>
+bool isRailInBoundary (int currentRail) {
+    return currentRail >= 0 ? (currentRail < Board::railAmount? true: false): false;
+}
+
+template <typename Mask>
+float coherenceBetweenBar (const Mask &activeBar, int barAmount) {
+   float cumulatedCoherence = .0f;
+   int prevActiveBar = INVALID_BAR_INDEX;
+   for (int i = 0; i < barAmount; ++i) {
+      if (isMaskBitSet(activeBar, i)) {
+          // Calculate current active bar and previous detected active bar's distance, get its reciprocal
+          if (prevActiveBar != INVALID_BAR_INDEX) {
+              cumulatedCoherence += 1.0f / static_cast<float>(i - prevActiveBar);
+          }
+          prevActiveBar = i;
+      }
+   }
+   return prevActiveBar==INVALID_BAR_INDEX ? INFINITY_COHERENCE : cumulatedCoherence;
+}
+
+template <typename Board>
+float coherenceBetweenBar (const RailStatus<Board> *rail) {
+    return coherenceBetweenBar(rail->m_activeBar, Board::barAmount);
+}
+
+// Latency
+int latencyBucket (uint64_t latency) {
+    if (latency < LATENCY_SUB_BUCKET_AMOUNT) {
+        return static_cast<int>(latency);
+    }
+    int exponent = 0;
+    while (exponent < LATENCY_MAXIMUM_EXPONENT && (latency >> (exponent + 1))) {
+        exponent++;
+    }
+    if (exponent >= LATENCY_MAXIMUM_EXPONENT) {
+        return LATENCY_BUCKET_AMOUNT - 1;
+    }
+    int subBucket = static_cast<int>(latency >> (exponent - LATENCY_SUB_BUCKET_BITS)) & (LATENCY_SUB_BUCKET_AMOUNT - 1);
+    return (exponent - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKET_AMOUNT + subBucket;
+}
+
+// Smallest latency falling in bucket
+uint64_t latencyBucketLowerBound (int bucket) {
+    if (bucket < LATENCY_SUB_BUCKET_AMOUNT) {
+        return bucket;
+    }
+    int exponent = bucket / LATENCY_SUB_BUCKET_AMOUNT + LATENCY_SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = bucket % LATENCY_SUB_BUCKET_AMOUNT;
+    return (LATENCY_SUB_BUCKET_AMOUNT + subBucket) << (exponent - LATENCY_SUB_BUCKET_BITS);
+}
+
+void recordLatency (LatencyHistogram *histogram, std::chrono::steady_clock::duration latency) {
+    uint64_t value = static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(), 0));
+    histogram->m_bucket[latencyBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    histogram->m_count.fetch_add(1, std::memory_order_relaxed);
+    histogram->m_sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t maximum = histogram->m_maximum.load(std::memory_order_relaxed);
+    while (value > maximum && !histogram->m_maximum.compare_exchange_weak(maximum, value, std::memory_order_relaxed)) { }
+}
+
+// Highest latency of the bucket holding the ratio quantile, never above the recorded maximum. Histograms being
+// recorded meanwhile give a quantile of some recent state.
+uint64_t latencyQuantile (const LatencyHistogram *histogram, double ratio) {
+    uint64_t count = 0;
+    for (int i = 0; i < LATENCY_BUCKET_AMOUNT; ++i) {
+        count += histogram->m_bucket[i].load(std::memory_order_relaxed);
+    }
+    uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(ratio * count)), 1);
+    uint64_t maximum = histogram->m_maximum.load(std::memory_order_relaxed);
+    uint64_t cumulative = 0;
+    for (int i = 0; i < LATENCY_BUCKET_AMOUNT - 1; ++i) {
+        cumulative += histogram->m_bucket[i].load(std::memory_order_relaxed);
+        if (cumulative >= rank) {
+            return std::min(latencyBucketLowerBound(i + 1) - 1, maximum);
+        }
+    }
+    return maximum;
+}
+
+// Stages between points the game loop has set, frames published after an input carry the points to GUI
+void recordGameLoopLatency (LatencyRecorder *recorder, const std::chrono::steady_clock::time_point *point) {
+    recordLatency(&recorder->m_stage[INPUT_QUEUE_STAGE], point[INPUT_TAKEN_POINT] - point[INPUT_POSTED_POINT]);
+    recordLatency(&recorder->m_stage[RAIL_INPUT_UPDATE_STAGE], point[RAIL_UPDATED_POINT] - point[INPUT_TAKEN_POINT]);
+    recordLatency(&recorder->m_stage[UPDATE_GAME_INFO_STAGE], point[GAME_UPDATED_POINT] - point[RAIL_UPDATED_POINT]);
+    recordLatency(&recorder->m_stage[INPUT_TO_DECISION_STAGE], point[GAME_UPDATED_POINT] - point[INPUT_POSTED_POINT]);
+}
+
+void recordFlushLatency (LatencyRecorder *recorder, const std::chrono::steady_clock::time_point *point) {
+    recordLatency(&recorder->m_stage[PUBLISH_FRAME_STAGE], point[FRAME_PUBLISHED_POINT] - point[GAME_UPDATED_POINT]);
+    recordLatency(&recorder->m_stage[FLUSH_FRAME_STAGE], point[FRAME_FLUSHED_POINT] - point[FRAME_PUBLISHED_POINT]);
+    recordLatency(&recorder->m_stage[INPUT_TO_FLUSH_STAGE], point[FRAME_FLUSHED_POINT] - point[INPUT_POSTED_POINT]);
+}
+
+// Stages nobody recorded are left out, unit (us)
+void printLatencyReport (FILE *file, const LatencyRecorder *recorder) {
+    const char *stageName[LATENCY_STAGE_AMOUNT] = {"input queue", "railInputUpdate", "updateGameInfo", "publish frame", "flush frame", "input to decision", "input to flush"};
+    fprintf(file, "\nLatency (us):\n");
+    fprintf(file, "  %-18s %10s %10s %10s %10s %10s %10s %10s\n", "stage", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int i = 0; i < LATENCY_STAGE_AMOUNT; ++i) {
+        const LatencyHistogram *histogram = &recorder->m_stage[i];
+        uint64_t count = histogram->m_count.load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        fprintf(file, "  %-18s %10llu %10.1lf %10.1lf %10.1lf %10.1lf %10.1lf %10.1lf\n", stageName[i], static_cast<unsigned long long>(count),
+            histogram->m_sum.load(std::memory_order_relaxed) * 1e-3 / count, latencyQuantile(histogram, 0.5) * 1e-3, latencyQuantile(histogram, 0.9) * 1e-3,
+            latencyQuantile(histogram, 0.99) * 1e-3, latencyQuantile(histogram, 0.999) * 1e-3, histogram->m_maximum.load(std::memory_order_relaxed) * 1e-3);
+    }
+    fflush(file);
+}
+
+// Signals are turned into LATENCY_REPORT_EVENT and QUIT_EVENT by a thread sleeping until one arrives.
+// NOTICE: call before any other thread is started, threads started later inherit the blocked signals
+#ifdef _WIN32
+// Console control handler runs on a thread of its own, so it can post the event itself
+std::function<void ()> consoleQuitHandler;
+
+BOOL WINAPI handleConsoleControl (DWORD) {
+    consoleQuitHandler();
+    return TRUE;
+}
+
+template <typename Board>
+void startSignalThread (GameEventQueue<Board> *queue) {
+    consoleQuitHandler = [queue] () { postGameEvent(queue, QUIT_EVENT); };
+    SetConsoleCtrlHandler(handleConsoleControl, TRUE);
+}
+#elif __unix__
+template <typename Board>
+void startSignalThread (GameEventQueue<Board> *queue) {
+    sigset_t signalSet;
+    sigemptyset(&signalSet);
+    sigaddset(&signalSet, SIGUSR1);
+    sigaddset(&signalSet, SIGINT);
+    sigaddset(&signalSet, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signalSet, nullptr);
+    std::thread([queue, signalSet] () {
+        int signalNumber;
+        while (sigwait(&signalSet, &signalNumber) == 0) {
+            postGameEvent(queue, signalNumber == SIGUSR1 ? LATENCY_REPORT_EVENT : QUIT_EVENT);
+        }
+    }).detach();
+}
+#endif
+
+#ifdef __unix__
+// Stand-in of conio getch(), arrow key escape sequence is translated to conio's 224 prefixed key code
+int getch () {
+    static int pendingKey = -1;
+    if (pendingKey >= 0) {
+        int key = pendingKey;
+        pendingKey = -1;
+        return key;
+    }
+    termios originalTerm, rawTerm;
+    tcgetattr(STDIN_FILENO, &originalTerm);
+    rawTerm = originalTerm;
+    rawTerm.c_lflag &= ~(ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &rawTerm);
+    int ch = getchar();
+    if (ch == 27 && (ch = getchar()) == '[') {
+        switch (getchar()) {
+            case 'A': pendingKey = 72; break;
+            case 'B': pendingKey = 80; break;
+            case 'C': pendingKey = 77; break;
+            case 'D': pendingKey = 75; break;
+        }
+        ch = 224;
+    }
+    tcsetattr(STDIN_FILENO, TCSANOW, &originalTerm);
+    return ch;
+}
+#endif
+
+// Input update
+template <typename Board>
+void railInputMapping (float physicalOffsetOnRailTrack, RailStatus<Board> *rail) {
     // Hardware dependent
-    rail->m_offset = physicalOffsetOnRailTrack / UNIT_PHYSICAL_OFFSET;
+    rail->m_offset = physicalOffsetOnRailTrack / Board::unitPhysicalOffset;
 }
 
-void railInputUpdate (const InputStatus *inputStatus, GameStatus *game) {
-    for (int i = 0;i < SLIDING_RAIL_AMOUNT; ++i) {
+template <typename Board>
+void railInputUpdate (const InputStatus<Board> *inputStatus, GameStatus<Board> *game) {
+    for (int i = 0;i < Board::railAmount; ++i) {
         railInputMapping(inputStatus->m_physicalOffset[i], &game->m_railStatusList[i]);
     }
 }
 
+// Sensor input
+// Linear encoders stream batches of samples, a uint32 sample amount then per sample uint16 rail, uint16 reserved
+// and float physical offset, all little endian. Source is a file, a pipe ("-" is stdin) or "unix:path" socket.
+typedef struct SensorSample {
+    int m_rail;
+
+    float m_physicalOffset;
+
+} SensorSample;
+
+typedef struct SensorSource {
+    FILE *m_file;
+
+    // Samples left in the batch being read
+    uint32_t m_remainingSample;
+
+} SensorSource;
+
+// Offset level of each rail committed from samples, noise around a level boundary neither flips the level nor
+// wakes the game loop
+template <typename Board>
+struct SensorFilter {
+    int m_level[Board::railAmount];
+
+    // Level the samples currently settle on and how many samples in a row did so
+    int m_pendingLevel[Board::railAmount];
+
+    int m_pendingSample[Board::railAmount];
+
+    size_t m_sampleAmount;
+
+    size_t m_levelChangeAmount;
+
+    // Samples of unknown rails or non-finite offsets
+    size_t m_invalidSampleAmount;
+
+    SensorFilter() : m_level{}, m_pendingLevel{}, m_pendingSample{}, m_sampleAmount(0), m_levelChangeAmount(0), m_invalidSampleAmount(0) { }
+
+};
+
+bool openSensorSource (SensorSource *source, const char *path) {
+    source->m_remainingSample = 0;
+    if (strcmp(path, "-") == 0) {
+        source->m_file = stdin;
+    } else if (strncmp(path, "unix:", 5) == 0) {
+#ifdef __unix__
+        int socketFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path + 5, sizeof(address.sun_path) - 1);
+        if (socketFd < 0 || connect(socketFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            if (socketFd >= 0) {
+                close(socketFd);
+            }
+            return false;
+        }
+        source->m_file = fdopen(socketFd, "rb");
+#else
+        source->m_file = nullptr;
+#endif
+    } else {
+        source->m_file = fopen(path, "rb");
+    }
+    return source->m_file != nullptr;
+}
+
+// Read up to capacity samples across batch boundaries, return 0 at end of stream
+size_t readSensorSample (SensorSource *source, SensorSample *sample, size_t capacity) {
+    uint8_t record[8];
+    size_t sampleAmount = 0;
+    while (sampleAmount < capacity) {
+        if (source->m_remainingSample == 0) {
+            // Only wait for the next batch when nothing is read yet
+            uint8_t header[4];
+            if (sampleAmount > 0 || fread(header, 1, 4, source->m_file) != 4) {
+                break;
+            }
+            source->m_remainingSample = header[0] | (header[1] << 8) | (header[2] << 16) | (static_cast<uint32_t>(header[3]) << 24);
+            continue;
+        }
+        if (fread(record, 1, 8, source->m_file) != 8) {
+            source->m_remainingSample = 0;
+            break;
+        }
+        uint32_t offsetBit = record[4] | (record[5] << 8) | (record[6] << 16) | (static_cast<uint32_t>(record[7]) << 24);
+        sample[sampleAmount].m_rail = record[0] | (record[1] << 8);
+        memcpy(&sample[sampleAmount].m_physicalOffset, &offsetBit, sizeof(offsetBit));
+        sampleAmount++;
+        source->m_remainingSample--;
+    }
+    return sampleAmount;
+}
+
+// Level a rail at physicalOffset settles on from level, the boundaries around level are pushed out by the hysteresis
+// band. The end stop is a level of its own as in railInputMapping(), reached at the stop itself.
+template <typename Board>
+int sensorLevel (float physicalOffset, int level) {
+    const float band = SENSOR_HYSTERESIS * Board::unitPhysicalOffset;
+    if (physicalOffset >= MAXIMUM_PHYSICAL_OFFSET_ON_RAIL) {
+        return Board::barAmount;
+    }
+    int upperLevel = physicalOffset - band >= 0 ? static_cast<int>((physicalOffset - band) / Board::unitPhysicalOffset) : 0;
+    if (upperLevel > level) {
+        return std::min(upperLevel, Board::barAmount - 1);
+    }
+    int lowerLevel = static_cast<int>((physicalOffset + band) / Board::unitPhysicalOffset);
+    return lowerLevel < level ? lowerLevel : level;
+}
+
+// Return true if the rail's committed level changed
+template <typename Board>
+bool filterSensorSample (SensorFilter<Board> *filter, const SensorSample *sample) {
+    filter->m_sampleAmount++;
+    if (sample->m_rail < 0 || sample->m_rail >= Board::railAmount || !std::isfinite(sample->m_physicalOffset)) {
+        filter->m_invalidSampleAmount++;
+        return false;
+    }
+    int rail = sample->m_rail;
+    int level = sensorLevel<Board>(clamp(sample->m_physicalOffset, 0, MAXIMUM_PHYSICAL_OFFSET_ON_RAIL), filter->m_level[rail]);
+    if (level == filter->m_level[rail]) {
+        filter->m_pendingSample[rail] = 0;
+        return false;
+    }
+    if (level != filter->m_pendingLevel[rail]) {
+        filter->m_pendingLevel[rail] = level;
+        filter->m_pendingSample[rail] = 0;
+    }
+    if (++filter->m_pendingSample[rail] < SENSOR_DEBOUNCE_SAMPLE) {
+        return false;
+    }
+    filter->m_level[rail] = level;
+    filter->m_pendingSample[rail] = 0;
+    filter->m_levelChangeAmount++;
+    return true;
+}
+
+// Physical offsets in the middle of committed levels, which railInputMapping() maps back to the same levels
+template <typename Board>
+void sensorInputStatus (const SensorFilter<Board> *filter, InputStatus<Board> *inputStatus) {
+    for (int i = 0; i < Board::railAmount; ++i) {
+        int level = filter->m_level[i];
+        inputStatus->m_physicalOffset[i] = level < Board::barAmount ? (level + 0.5f) * Board::unitPhysicalOffset : MAXIMUM_PHYSICAL_OFFSET_ON_RAIL;
+    }
+}
+
 // Game related
-const float MAXIMUM_COHERENCE = 3.693f;
+constexpr float MAXIMUM_COHERENCE = 3.693f;
+
+// A single bar has zero coherence, so these keep at least one valid mask with nonzero weight
+static_assert(MAXIMUM_COHERENCE > 0, "Coherence upper bound must be positive");
+static_assert(RAIL_BAR_GENERATE_PROBABILITY > 0 && RAIL_BAR_GENERATE_PROBABILITY < 1, "Rail bar generate probability must be in (0, 1)");
+
+// Vose's alias method over the valid masks of SegmentBar bars weighted by p^bars * (1 - p)^(SegmentBar - bars)
+template <int SegmentBar>
+RailMaskSampler buildRailMaskSampler () {
+    const double p = RAIL_BAR_GENERATE_PROBABILITY;
+    std::vector<uint16_t> validMask;
+    std::vector<double> weight;
+    double totalWeight = .0;
+    for (uint32_t mask = 0; mask < MASK_AT(SegmentBar); ++mask) {
+        if (coherenceBetweenBar(mask, SegmentBar) < MAXIMUM_COHERENCE) {
+            int bars = BIT_COUNT(mask);
+            validMask.push_back(mask);
+            weight.push_back(pow(p, bars) * pow(1 - p, SegmentBar - bars));
+            totalWeight += weight.back();
+        }
+    }
+
+    RailMaskSampler sampler;
+    sampler.m_validProbability = totalWeight;
+    size_t n = validMask.size();
+    sampler.m_alias.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<size_t> small, large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weight[i] * n / totalWeight;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        size_t less = small.back(), more = large.back();
+        small.pop_back();
+        sampler.m_alias[less].m_mask = validMask[less];
+        sampler.m_alias[less].m_aliasMask = validMask[more];
+        sampler.m_alias[less].m_threshold = static_cast<uint32_t>(scaled[less] * 4294967296.0);
+        scaled[more] -= 1 - scaled[less];
+        if (scaled[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // Leftovers are 1 up to rounding error
+    for (size_t i : small) {
+        large.push_back(i);
+    }
+    for (size_t i : large) {
+        sampler.m_alias[i].m_mask = sampler.m_alias[i].m_aliasMask = validMask[i];
+        sampler.m_alias[i].m_threshold = UINT32_MAX;
+    }
+    return sampler;
+}
+
+template <int SegmentBar>
+const RailMaskSampler *railMaskSampler () {
+    // Built on first use, initialization of local static is thread-safe
+    static const RailMaskSampler sampler = buildRailMaskSampler<SegmentBar>();
+    return &sampler;
+}
+
+uint16_t sampleRailMask (const RailMaskSampler *sampler, RandomEngine *engine) {
+    // High half picks the column, low half picks between mask and its alias
+    uint64_t r = nextRandom(engine);
+    const RailMaskAlias *column = &sampler->m_alias[((r >> 32) * sampler->m_alias.size()) >> 32];
+    return static_cast<uint32_t>(r) < column->m_threshold ? column->m_mask : column->m_aliasMask;
+}
 
-RailStatus *generateGhostLegGraph () {
-    // DYNAMIC: Declare rail status memory space and initialize it
-    RailStatus *railList = new RailStatus[SLIDING_RAIL_AMOUNT]();
+// Draw every rail of railList again, offsets are reset
+template <typename Board>
+void generateGhostLegGraph (RailStatus<Board> *railList, RandomEngine *engine, int *totalRegenerateTime = nullptr) {
+    const RailMaskSampler *sampler = railMaskSampler<Board::segmentBarAmount>();
     int regenerateTime = 0;
-    for (int i = 0; i < SLIDING_RAIL_AMOUNT; ++i) {
-        // Ensure coherence between bars of current rail is under specified MAXIMUM_COHERENCE
-        do {
-            railList[i].m_activeBar = 0;
-            for (int j = 0; j < MAXIMUM_BAR; ++j) {
-                if (randomFloat() <= RAIL_BAR_GENERATE_PROBABILITY) {
-                    railList[i].m_activeBar = railList[i].m_activeBar | MASK_AT(j);
-                }
-            }
+    for (int i = 0; i < Board::railAmount; ++i) {
+        railList[i] = RailStatus<Board>();
+        // Only masks with coherence under MAXIMUM_COHERENCE are ever drawn, long rails bound it per segment
+        for (int j = 0; j < Board::barAmount / Board::segmentBarAmount; ++j) {
+            setMaskSegment(&railList[i].m_activeBar, j, sampleRailMask(sampler, engine));
             regenerateTime++;
-            if (regenerateTime > 10000) {
-                printf("The graph is too hard to generate, please either change\nyour coherence upper bound or change your rail bar generate probability.\n");
-                exit(1);
-            }
-        } while (coherenceBetweenBar(&railList[i]) >= MAXIMUM_COHERENCE);
+        }
+    }
+    if (totalRegenerateTime) {
+        *totalRegenerateTime += regenerateTime;
+    }
+}
+
+// Ghost leg tracer
+// A rail only joins its two tracks on interleaved positions whose parity differs from the rail's,
+// so the bars on one position are disjoint adjacent-track swaps. Each position is stored as a swap layer
+// (lane mask of the lower track of every swapped pair) and the board is traced for all start tracks at once
+// by applying one delta swap per layer on the packed track lanes.
+// Wide boards keep a 16 bits lane per track and a rail mask per swap layer, and a layer is applied on
+// a vector of lanes at once, each lane taking its upper or lower neighbour where that pair swaps.
+#if !defined(SCALAR_TRACER) && defined(__AVX2__)
+  #define AVX2_TRACER
+  #define TRACER_ISA "AVX2"
+#elif !defined(SCALAR_TRACER) && defined(__SSE2__)
+  #define SSE2_TRACER
+  #define TRACER_ISA "SSE2"
+#else
+  #define TRACER_ISA "scalar"
+#endif
+
+inline void setIdentityOccupancy (uint64_t *occupancy, int trackAmount) {
+    *occupancy = ~0ULL; // unused lanes are 0xF, which never match a start track
+    for (int i = 0; i < trackAmount; ++i) {
+        *occupancy = (*occupancy & ~TRACK_LANE(i)) | (static_cast<uint64_t>(i) << (i * TRACK_LANE_BITS));
+    }
+}
+
+template <int Tracks>
+void setIdentityOccupancy (WideOccupancy<Tracks> *occupancy, int) {
+    for (int i = 0; i < WideOccupancy<Tracks>::laneStride; ++i) {
+        occupancy->m_lane[i] = NO_START_TRACK;
+    }
+    for (int i = 0; i < Tracks; ++i) {
+        occupancy->m_lane[WideOccupancy<Tracks>::laneBase + i] = i;
+    }
+}
+
+void addRailSwapLayer (uint16_t activeBar, size_t offset, int railId, uint64_t *swapLayer) {
+    // Bar at local position b of an offset rail sits on global bar position b+offset
+    uint32_t shiftedBar = static_cast<uint32_t>(activeBar) << offset;
+    while (shiftedBar) {
+        int globalBarPos = LOWEST_BIT_INDEX(shiftedBar);
+        swapLayer[2 * globalBarPos + ((railId & 1) ^ 1)] |= TRACK_LANE(railId);
+        shiftedBar &= shiftedBar - 1;
+    }
+}
+
+template <typename Mask, int Tracks>
+void addRailSwapLayer (const Mask &activeBar, size_t offset, int railId, WideMask<Tracks> *swapLayer) {
+    forEachMaskBit(activeBar, [&] (int bar) {
+        setMaskBit(&swapLayer[2 * (bar + offset) + ((railId & 1) ^ 1)], railId);
+    });
+}
+
+template <typename Board>
+void buildSwapLayer (const RailStatus<Board> *railList, size_t RailStatus<Board>::*offset, typename Board::SwapLayer *swapLayer) {
+    for (int i = 0; i < Board::interleaveTrackPosAmount; ++i) {
+        swapLayer[i] = typename Board::SwapLayer();
+    }
+    for (int i = 0; i < Board::railAmount; ++i) {
+        addRailSwapLayer(railList[i].m_activeBar, railList[i].*offset, i, swapLayer);
+    }
+}
+
+inline uint64_t applySwapLayer (uint64_t occupancy, uint64_t swapLayer) {
+    uint64_t diff = (occupancy ^ (occupancy >> TRACK_LANE_BITS)) & swapLayer;
+    return occupancy ^ diff ^ (diff << TRACK_LANE_BITS);
+}
+
+// Lane t takes lane t+1 where rail t swaps (upper) and lane t-1 where rail t-1 swaps (lower)
+template <int Tracks>
+void applySwapLayer (const WideOccupancy<Tracks> &from, const WideMask<Tracks> &swapLayer, WideOccupancy<Tracks> *to) {
+    const uint16_t *source = from.m_lane + WideOccupancy<Tracks>::laneBase;
+    uint16_t *target = to->m_lane + WideOccupancy<Tracks>::laneBase;
+    uint32_t carry = 0; // swap bit of the lane before current vector
+#if defined(AVX2_TRACER)
+    const __m256i laneBit = _mm256_setr_epi16(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80, 0x100, 0x200, 0x400, 0x800, 0x1000, 0x2000, 0x4000, static_cast<short>(0x8000));
+    for (int i = 0; i < WideOccupancy<Tracks>::laneAmount; i += 16) {
+        uint32_t upper = maskChunk(swapLayer, i, 16);
+        uint32_t lower = ((upper << 1) | carry) & 0xFFFF;
+        carry = upper >> 15;
+        __m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+        if (upper | lower) {
+            __m256i upperMask = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(upper)), laneBit), laneBit);
+            __m256i lowerMask = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(static_cast<short>(lower)), laneBit), laneBit);
+            lane = _mm256_blendv_epi8(lane, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i + 1)), upperMask);
+            lane = _mm256_blendv_epi8(lane, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i - 1)), lowerMask);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + i), lane);
+    }
+#elif defined(SSE2_TRACER)
+    const __m128i laneBit = _mm_setr_epi16(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80);
+    for (int i = 0; i < WideOccupancy<Tracks>::laneAmount; i += 8) {
+        uint32_t upper = maskChunk(swapLayer, i, 8);
+        uint32_t lower = ((upper << 1) | carry) & 0xFF;
+        carry = upper >> 7;
+        __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+        if (upper | lower) {
+            __m128i upperMask = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(static_cast<short>(upper)), laneBit), laneBit);
+            __m128i lowerMask = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(static_cast<short>(lower)), laneBit), laneBit);
+            __m128i upperLane = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i + 1));
+            __m128i lowerLane = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i - 1));
+            lane = _mm_or_si128(_mm_and_si128(upperMask, upperLane), _mm_andnot_si128(upperMask, lane));
+            lane = _mm_or_si128(_mm_and_si128(lowerMask, lowerLane), _mm_andnot_si128(lowerMask, lane));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(target + i), lane);
+    }
+#else
+    for (int i = 0; i < WideOccupancy<Tracks>::laneAmount; ++i) {
+        uint32_t upper = isMaskBitSet(swapLayer, i) ? 1 : 0;
+        target[i] = upper ? source[i + 1] : (carry ? source[i - 1] : source[i]);
+        carry = upper;
+    }
+#endif
+}
+
+// Swap layers from Position to the end of board, unrolled at compile time
+template <typename Board, int Position, bool IsEnd = (Position >= Board::interleaveTrackPosAmount)>
+struct UnrolledSwapLayer {
+    static inline uint64_t compose (const uint64_t *swapLayer, uint64_t occupancy) {
+        return UnrolledSwapLayer<Board, Position + 1>::compose(swapLayer, applySwapLayer(occupancy, swapLayer[Position]));
+    }
+
+    static inline void trace (const uint64_t *swapLayer, uint64_t *occupancyList) {
+        occupancyList[Position + 1] = applySwapLayer(occupancyList[Position], swapLayer[Position]);
+        UnrolledSwapLayer<Board, Position + 1>::trace(swapLayer, occupancyList);
+    }
+};
+
+template <typename Board, int Position>
+struct UnrolledSwapLayer<Board, Position, true> {
+    static inline uint64_t compose (const uint64_t *, uint64_t occupancy) {
+        return occupancy;
+    }
+
+    static inline void trace (const uint64_t *, uint64_t *) { }
+};
+
+// Return the end occupancy without recording history
+template <typename Board>
+uint64_t composeSwapLayer (const uint64_t *swapLayer) {
+    uint64_t occupancy;
+    setIdentityOccupancy(&occupancy, Board::trackAmount);
+    return UnrolledSwapLayer<Board, 0>::compose(swapLayer, occupancy);
+}
+
+void removeRailSwapLayer (uint16_t activeBar, size_t offset, int railId, uint64_t *swapLayer) {
+    uint32_t shiftedBar = static_cast<uint32_t>(activeBar) << offset;
+    while (shiftedBar) {
+        int globalBarPos = LOWEST_BIT_INDEX(shiftedBar);
+        swapLayer[2 * globalBarPos + ((railId & 1) ^ 1)] &= ~TRACK_LANE(railId);
+        shiftedBar &= shiftedBar - 1;
+    }
+}
+
+template <typename Mask, int Tracks>
+void removeRailSwapLayer (const Mask &activeBar, size_t offset, int railId, WideMask<Tracks> *swapLayer) {
+    forEachMaskBit(activeBar, [&] (int bar) {
+        clearMaskBit(&swapLayer[2 * (bar + offset) + ((railId & 1) ^ 1)], railId);
+    });
+}
+
+// First interleaved position a rail can swap on with given offset
+template <typename Board, typename Mask>
+int firstRailSwapPos (const Mask &activeBar, size_t offset, int railId) {
+    int lowestBar = lowestMaskBit(activeBar);
+    if (lowestBar < 0) {
+        return Board::interleaveTrackPosAmount;
+    }
+    return 2 * (lowestBar + offset) + ((railId & 1) ^ 1);
+}
+
+// Resume tracing from trackPos, trace->m_occupancy[trackPos] must be up to date
+template <typename Board>
+void traceSwapLayerFrom (const uint64_t *swapLayer, GhostLegTrace<Board> *trace, int trackPos) {
+    if (trackPos == 0) {
+        UnrolledSwapLayer<Board, 0>::trace(swapLayer, trace->m_occupancy);
+        return;
+    }
+    uint64_t occupancy = trace->m_occupancy[trackPos];
+    for (int i = trackPos; i < Board::interleaveTrackPosAmount; ++i) {
+        occupancy = applySwapLayer(occupancy, swapLayer[i]);
+        trace->m_occupancy[i + 1] = occupancy;
+    }
+}
+
+template <typename Board, int Tracks>
+void traceSwapLayerFrom (const WideMask<Tracks> *swapLayer, GhostLegTrace<Board> *trace, int trackPos) {
+    for (int i = trackPos; i < Board::interleaveTrackPosAmount; ++i) {
+        applySwapLayer(trace->m_occupancy[i], swapLayer[i], &trace->m_occupancy[i + 1]);
+    }
+}
+
+template <typename Board>
+void traceSwapLayer (const typename Board::SwapLayer *swapLayer, GhostLegTrace<Board> *trace) {
+    setIdentityOccupancy(&trace->m_occupancy[0], Board::trackAmount);
+    traceSwapLayerFrom(swapLayer, trace, 0);
+}
+
+
+inline int trackOfStart (uint64_t occupancy, int startTrack) {
+    // Find the zero lane, the lowest flagged lane is always exact
+    uint64_t diff = occupancy ^ REPEAT_LANE(startTrack);
+    uint64_t zeroLane = (diff - REPEAT_LANE(1)) & ~diff & REPEAT_LANE(8);
+    return LOWEST_BIT_INDEX(zeroLane) / TRACK_LANE_BITS;
+}
+
+template <int Tracks>
+int trackOfStart (const WideOccupancy<Tracks> &occupancy, int startTrack) {
+    const uint16_t *lane = occupancy.m_lane + WideOccupancy<Tracks>::laneBase;
+#if defined(AVX2_TRACER)
+    const __m256i start = _mm256_set1_epi16(static_cast<short>(startTrack));
+    for (int i = 0; i < WideOccupancy<Tracks>::laneAmount; i += 16) {
+        uint32_t hit = _mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(lane + i)), start));
+        if (hit) {
+            return i + LOWEST_BIT_INDEX(hit) / 2;
+        }
+    }
+#elif defined(SSE2_TRACER)
+    const __m128i start = _mm_set1_epi16(static_cast<short>(startTrack));
+    for (int i = 0; i < WideOccupancy<Tracks>::laneAmount; i += 8) {
+        uint32_t hit = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lane + i)), start));
+        if (hit) {
+            return i + LOWEST_BIT_INDEX(hit) / 2;
+        }
+    }
+#else
+    for (int i = 0; i < Tracks; ++i) {
+        if (lane[i] == startTrack) {
+            return i;
+        }
+    }
+#endif
+    return -1;
+}
+
+// Start track currently on track
+inline int startOnTrack (uint64_t occupancy, int track) {
+    return (occupancy >> (track * TRACK_LANE_BITS)) & 0xF;
+}
+
+template <int Tracks>
+inline int startOnTrack (const WideOccupancy<Tracks> &occupancy, int track) {
+    return occupancy.m_lane[WideOccupancy<Tracks>::laneBase + track];
+}
+
+// End track of startTrack without recording history
+template <typename Board>
+int composeEndTrack (const uint64_t *swapLayer, int startTrack) {
+    return trackOfStart(composeSwapLayer<Board>(swapLayer), startTrack);
+}
+
+// Only start track is followed on wide boards, it steps to the upper or lower track where its pair swaps
+template <typename Board, int Tracks>
+int composeEndTrack (const WideMask<Tracks> *swapLayer, int startTrack) {
+    int track = startTrack;
+    for (int i = 0; i < Board::interleaveTrackPosAmount; ++i) {
+        if (isMaskBitSet(swapLayer[i], track)) {
+            track++;
+        } else if (track > 0 && isMaskBitSet(swapLayer[i], track - 1)) {
+            track--;
+        }
+    }
+    return track;
+}
+
+template <typename Board>
+inline int traceTrackAt (const GhostLegTrace<Board> *trace, int trackPos, int startTrack) {
+    return trackOfStart(trace->m_occupancy[trackPos], startTrack);
+}
+
+template <typename Board>
+inline int traceEndTrack (const GhostLegTrace<Board> *trace, int startTrack) {
+    return trackOfStart(trace->m_occupancy[Board::interleaveTrackPosAmount], startTrack);
+}
+
+// Offset tuple solver
+// Offset tuples are encoded as base offsetLevelAmount digits, rail 0 as the lowest digit
+template <typename Board>
+size_t encodeOffsetTuple (const size_t *offsetList) {
+    size_t tuple = 0;
+    for (int i = Board::railAmount - 1; i >= 0; --i) {
+        tuple = tuple * Board::offsetLevelAmount + offsetList[i];
+    }
+    return tuple;
+}
+
+template <typename Board>
+size_t encodeRailOffset (const RailStatus<Board> *railList, size_t RailStatus<Board>::*offset) {
+    size_t offsetList[Board::railAmount];
+    for (int i = 0; i < Board::railAmount; ++i) {
+        offsetList[i] = railList[i].*offset;
+    }
+    return encodeOffsetTuple<Board>(offsetList);
+}
+
+template <typename Board>
+void decodeOffsetTuple (size_t tuple, size_t *offsetList) {
+    for (int i = 0; i < Board::railAmount; ++i) {
+        offsetList[i] = tuple % Board::offsetLevelAmount;
+        tuple /= Board::offsetLevelAmount;
+    }
+}
+
+// Walk every offset tuple in odometer order and call visit(tuple, trace, changedPos), where the trace entries
+// from changedPos on are the only ones changed since previous tuple. A step only moves a few rails, so the
+// trace prefix before the first position those rails can swap on is reused.
+template <typename Board, typename Visitor>
+void enumerateOffsetSpace (const RailStatus<Board> *railList, Visitor visit) {
+    size_t offsetList[Board::railAmount] = {};
+    uint64_t swapLayer[Board::interleaveTrackPosAmount] = {};
+    GhostLegTrace<Board> trace;
+    for (int i = 0; i < Board::railAmount; ++i) {
+        addRailSwapLayer(railList[i].m_activeBar, 0, i, swapLayer);
+    }
+    traceSwapLayer(swapLayer, &trace);
+
+    int firstChangedPos = 0;
+    for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+        visit(tuple, static_cast<const GhostLegTrace<Board> *>(&trace), firstChangedPos);
+        firstChangedPos = Board::interleaveTrackPosAmount;
+        for (int i = 0; i < Board::railAmount; ++i) {
+            size_t nextOffset = (offsetList[i] + 1) % Board::offsetLevelAmount;
+            removeRailSwapLayer(railList[i].m_activeBar, offsetList[i], i, swapLayer);
+            addRailSwapLayer(railList[i].m_activeBar, nextOffset, i, swapLayer);
+            firstChangedPos = std::min(firstChangedPos, firstRailSwapPos<Board>(railList[i].m_activeBar, std::min(offsetList[i], nextOffset), i));
+            offsetList[i] = nextOffset;
+            if (nextOffset != 0) {
+                break;
+            }
+        }
+        if (firstChangedPos < Board::interleaveTrackPosAmount) {
+            traceSwapLayerFrom(swapLayer, &trace, firstChangedPos);
+        }
+    }
+}
+
+// Signature of each tuple is recorded as well if signature isn't nullptr
+template <typename Board>
+size_t solveOffsetSpace (const RailStatus<Board> *railList, int startTrack, int endTrack, uint64_t *solutionSet, uint16_t *signature = nullptr) {
+    for (size_t i = 0; i < Board::offsetTupleWords; ++i) {
+        solutionSet[i] = 0;
+    }
+    size_t solutionAmount = 0;
+    enumerateOffsetSpace(railList, [&] (size_t tuple, const GhostLegTrace<Board> *trace, int) {
+        int currentEndTrack = traceEndTrack(trace, startTrack);
+        if (currentEndTrack == endTrack) {
+            solutionSet[tuple / 64] |= MASK_AT(tuple % 64);
+            solutionAmount++;
+        }
+#ifdef OFFSET_SIGNATURE
+        if (signature) {
+            uint16_t tupleSignature = currentEndTrack << (3 * Board::checkpointAmount);
+            for (int i = 0; i < Board::checkpointAmount; ++i) {
+                tupleSignature |= traceTrackAt(trace, (i + 1) * Board::checkpointSpacing, startTrack) << (3 * i);
+            }
+            signature[tuple] = tupleSignature;
+        }
+#else
+        (void)signature;
+#endif
+    });
+    return solutionAmount;
+}
+
+// Return the index of n-th (0-based) solution in the set
+size_t selectSolution (const uint64_t *solutionSet, size_t n) {
+    size_t word = 0;
+    while (BIT_COUNT(solutionSet[word]) <= n) {
+        n -= BIT_COUNT(solutionSet[word]);
+        word++;
+    }
+    uint64_t bits = solutionSet[word];
+    for (; n > 0; --n) {
+        bits &= bits - 1;
+    }
+    return word * 64 + LOWEST_BIT_INDEX(bits);
+}
+
+// Batch evaluator
+// End track and checkpoints passed by start track for many offset tuples at once, each lane follows its own
+// tuple. Tuples are in structure of arrays form, so one load brings a rail's offsets of a whole lane group.
+#define BATCH_LANE_AMOUNT 8
+
+template <typename Board>
+struct OffsetTupleBatch {
+    // Offset of rail r in tuple k is m_offset[r * m_tupleStride + k], stride is whole lane groups
+    uint16_t *m_offset;
+
+    size_t m_tupleStride;
+
+    size_t m_tupleAmount;
+
+    // Track start track ends on, and checkpoints it passes, bit i is the checkpoint position (i + 1) * checkpointSpacing.
+    // Multiple set checkpoints lie off those positions too, so it's the amount passed instead
+    uint16_t *m_endTrack;
+
+    uint32_t *m_checkpointHit;
+
+    static constexpr int checkpointPosAmount = (Board::interleaveTrackPosAmount - 1) / Board::checkpointSpacing;
+
+    static_assert(checkpointPosAmount <= 32, "Checkpoint hit mask must fit in 32 bits");
+    static_assert(Board::offsetLevelAmount <= 0x10000, "Offsets must fit in 16 bits");
+};
+
+template <typename Board>
+OffsetTupleBatch<Board> *createOffsetTupleBatch (size_t tupleAmount) {
+    OffsetTupleBatch<Board> *batch = new OffsetTupleBatch<Board>();
+    batch->m_tupleStride = (tupleAmount + BATCH_LANE_AMOUNT - 1) / BATCH_LANE_AMOUNT * BATCH_LANE_AMOUNT;
+    batch->m_tupleAmount = tupleAmount;
+    batch->m_offset = new uint16_t[Board::railAmount * batch->m_tupleStride]();
+    batch->m_endTrack = new uint16_t[batch->m_tupleStride]();
+    batch->m_checkpointHit = new uint32_t[batch->m_tupleStride]();
+    return batch;
+}
+
+template <typename Board>
+void destroyOffsetTupleBatch (OffsetTupleBatch<Board> *batch) {
+    delete [] batch->m_offset;
+    delete [] batch->m_endTrack;
+    delete [] batch->m_checkpointHit;
+    delete batch;
+}
+
+// Fill the batch with tupleAmount consecutive tuples from firstTuple in encodeOffsetTuple() order
+template <typename Board>
+void decodeOffsetTupleBatch (size_t firstTuple, size_t tupleAmount, OffsetTupleBatch<Board> *batch) {
+    size_t offsetList[Board::railAmount];
+    decodeOffsetTuple<Board>(firstTuple, offsetList);
+    batch->m_tupleAmount = tupleAmount;
+    for (size_t k = 0; k < tupleAmount; ++k) {
+        for (int i = 0; i < Board::railAmount; ++i) {
+            batch->m_offset[i * batch->m_tupleStride + k] = static_cast<uint16_t>(offsetList[i]);
+        }
+        for (int i = 0; i < Board::railAmount && ++offsetList[i] == static_cast<size_t>(Board::offsetLevelAmount); ++i) {
+            offsetList[i] = 0;
+        }
+    }
+}
+
+// Portable path, also the reference of lane groups. On interleaved position p, track t can only be swapped by
+// the one of rails t-1 and t whose parity differs from p, with its bar index p / 2 minus its offset.
+template <typename Board>
+void evaluateOffsetTuple (const GameStatus<Board> *game, OffsetTupleBatch<Board> *batch, size_t k) {
+    int track = static_cast<int>(game->m_startTrack);
+    uint32_t checkpointHit = 0;
+    for (int i = 0; i < Board::interleaveTrackPosAmount; ++i) {
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+        checkpointHit += isMaskBitSet(game->m_trackStatusList[track].m_checkpoint, i) ? 1 : 0;
+#else
+        if (i > 0 && i % Board::checkpointSpacing == 0 && isMaskBitSet(game->m_trackStatusList[track].m_checkpoint, i)) {
+            checkpointHit |= 1u << (i / Board::checkpointSpacing - 1);
+        }
+#endif
+        int rail = ((track ^ i) & 1) ? track : track - 1;
+        if (rail < 0 || rail >= Board::railAmount) {
+            continue;
+        }
+        int bar = i / 2 - batch->m_offset[rail * batch->m_tupleStride + k];
+        if (bar >= 0 && bar < Board::barAmount && isMaskBitSet(game->m_railStatusList[rail].m_activeBar, bar)) {
+            track += (rail == track) ? 1 : -1;
+        }
+    }
+    batch->m_endTrack[k] = static_cast<uint16_t>(track);
+    batch->m_checkpointHit[k] = checkpointHit;
+}
+
+// Lane groups need a rail's shifted bars and a rail mask per lane in 32 bits, wide boards take the portable path.
+// Lanes only test the checkpoint positions, so multiple set checkpoints take it as well
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+template <typename Board>
+using LaneEvaluatedTag = std::false_type;
+#else
+template <typename Board>
+using LaneEvaluatedTag = std::integral_constant<bool, !Board::isWideBoard>;
+#endif
+
+// Evaluate whole lane groups from tuple 0, return how many tuples are done
+template <typename Board>
+size_t evaluateOffsetTupleLaneGroup (const GameStatus<Board> *game, OffsetTupleBatch<Board> *batch, std::true_type) {
+#if defined(AVX2_TRACER) || defined(SSE2_TRACER)
+    // Tracks holding a checkpoint on each checkpoint position, bit t is track t
+    uint32_t checkpointTrack[OffsetTupleBatch<Board>::checkpointPosAmount + 1] = {};
+    for (int i = 0; i < OffsetTupleBatch<Board>::checkpointPosAmount; ++i) {
+        for (int j = 0; j < Board::trackAmount; ++j) {
+            checkpointTrack[i] |= (isMaskBitSet(game->m_trackStatusList[j].m_checkpoint, (i + 1) * Board::checkpointSpacing) ? 1u : 0u) << j;
+        }
+    }
+#endif
+#if defined(AVX2_TRACER)
+    const __m256i one = _mm256_set1_epi32(1);
+    // Rails swapping on an even position are odd rails and the other way round
+    const __m256i parityRail[2] = {_mm256_set1_epi32(0xAAAAAAAA), _mm256_set1_epi32(0x55555555)};
+    size_t k = 0;
+    for (; k + BATCH_LANE_AMOUNT <= batch->m_tupleAmount; k += BATCH_LANE_AMOUNT) {
+        // Bit g is a bar of the rail on global bar position g
+        __m256i shiftedBar[Board::railAmount];
+        for (int i = 0; i < Board::railAmount; ++i) {
+            __m256i offset = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(batch->m_offset + i * batch->m_tupleStride + k)));
+            shiftedBar[i] = _mm256_sllv_epi32(_mm256_set1_epi32(static_cast<int>(game->m_railStatusList[i].m_activeBar)), offset);
+        }
+        __m256i track = _mm256_set1_epi32(static_cast<int>(game->m_startTrack));
+        __m256i checkpointHit = _mm256_setzero_si256();
+        for (int g = 0; g < Board::trackPosAmount; ++g) {
+            // Bit r is rail r having a bar on g
+            __m256i railBar = _mm256_setzero_si256();
+            const __m128i barShift = _mm_cvtsi32_si128(g);
+            for (int i = 0; i < Board::railAmount; ++i) {
+                railBar = _mm256_or_si256(railBar, _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(shiftedBar[i], barShift), one), i));
+            }
+            for (int parity = 0; parity < 2; ++parity) {
+                int trackPos = 2 * g + parity;
+                if (trackPos > 0 && trackPos % Board::checkpointSpacing == 0) {
+                    int checkpointIndex = trackPos / Board::checkpointSpacing - 1;
+                    __m256i isHit = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(checkpointTrack[checkpointIndex]), track), one);
+                    checkpointHit = _mm256_or_si256(checkpointHit, _mm256_slli_epi32(isHit, checkpointIndex));
+                }
+                // Shift count -1 of track 0 yields 0, so no lane swaps below track 0
+                __m256i swapRail = _mm256_and_si256(railBar, parityRail[parity]);
+                __m256i upper = _mm256_and_si256(_mm256_srlv_epi32(swapRail, track), one);
+                __m256i lower = _mm256_and_si256(_mm256_srlv_epi32(swapRail, _mm256_sub_epi32(track, one)), one);
+                track = _mm256_sub_epi32(_mm256_add_epi32(track, upper), lower);
+            }
+        }
+        alignas(32) uint32_t laneTrack[BATCH_LANE_AMOUNT];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(laneTrack), track);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(batch->m_checkpointHit + k), checkpointHit);
+        for (int i = 0; i < BATCH_LANE_AMOUNT; ++i) {
+            batch->m_endTrack[k + i] = static_cast<uint16_t>(laneTrack[i]);
+        }
+    }
+    return k;
+#elif defined(SSE2_TRACER)
+    // SSE2 has no per lane shift count, so a lane keeps its track as bit t, and a tuple's shifted bars are built
+    // in scalar. Groups of 4 lanes, the stride is whole groups of 8.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i parityRail[2] = {_mm_set1_epi32(static_cast<int>(0xAAAAAAAA)), _mm_set1_epi32(0x55555555)};
+    size_t k = 0;
+    for (; k + 4 <= batch->m_tupleAmount; k += 4) {
+        __m128i shiftedBar[Board::railAmount];
+        for (int i = 0; i < Board::railAmount; ++i) {
+            const uint16_t *offset = batch->m_offset + i * batch->m_tupleStride + k;
+            uint32_t activeBar = static_cast<uint32_t>(game->m_railStatusList[i].m_activeBar);
+            shiftedBar[i] = _mm_setr_epi32(static_cast<int>(activeBar << offset[0]), static_cast<int>(activeBar << offset[1]),
+                static_cast<int>(activeBar << offset[2]), static_cast<int>(activeBar << offset[3]));
+        }
+        __m128i trackBit = _mm_set1_epi32(1 << game->m_startTrack);
+        __m128i checkpointHit = zero;
+        for (int g = 0; g < Board::trackPosAmount; ++g) {
+            __m128i railBar = zero;
+            const __m128i barShift = _mm_cvtsi32_si128(g);
+            for (int i = 0; i < Board::railAmount; ++i) {
+                railBar = _mm_or_si128(railBar, _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(shiftedBar[i], barShift), one), i));
+            }
+            for (int parity = 0; parity < 2; ++parity) {
+                int trackPos = 2 * g + parity;
+                if (trackPos > 0 && trackPos % Board::checkpointSpacing == 0) {
+                    int checkpointIndex = trackPos / Board::checkpointSpacing - 1;
+                    __m128i isMiss = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(checkpointTrack[checkpointIndex])), trackBit), zero);
+                    checkpointHit = _mm_or_si128(checkpointHit, _mm_andnot_si128(isMiss, _mm_set1_epi32(1 << checkpointIndex)));
+                }
+                // Rail t moves track t up and rail t-1 moves it down, and only one of them has the parity to swap
+                __m128i swapRail = _mm_and_si128(railBar, parityRail[parity]);
+                __m128i upper = _mm_and_si128(swapRail, trackBit);
+                __m128i lower = _mm_and_si128(swapRail, _mm_srli_epi32(trackBit, 1));
+                trackBit = _mm_xor_si128(trackBit, _mm_xor_si128(upper, _mm_slli_epi32(lower, 1)));
+                trackBit = _mm_or_si128(trackBit, _mm_or_si128(_mm_slli_epi32(upper, 1), lower));
+            }
+        }
+        alignas(16) uint32_t laneTrackBit[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(laneTrackBit), trackBit);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(batch->m_checkpointHit + k), checkpointHit);
+        for (int i = 0; i < 4; ++i) {
+            batch->m_endTrack[k + i] = static_cast<uint16_t>(LOWEST_BIT_INDEX(laneTrackBit[i]));
+        }
+    }
+    return k;
+#else
+    (void)game;
+    (void)batch;
+    return 0;
+#endif
+}
+
+template <typename Board>
+size_t evaluateOffsetTupleLaneGroup (const GameStatus<Board> *, OffsetTupleBatch<Board> *, std::false_type) {
+    return 0;
+}
+
+// Needs game's rails, checkpoints and start track, results are the same on every tracer
+template <typename Board>
+void evaluateOffsetTupleBatch (const GameStatus<Board> *game, OffsetTupleBatch<Board> *batch) {
+    size_t k = evaluateOffsetTupleLaneGroup(game, batch, LaneEvaluatedTag<Board>());
+    for (; k < batch->m_tupleAmount; ++k) {
+        evaluateOffsetTuple(game, batch, k);
+    }
+}
+
+// Same judgement as updateGameInfo() on tuple k of an evaluated batch
+template <typename Board>
+bool isOffsetTupleComplete (const GameStatus<Board> *game, const OffsetTupleBatch<Board> *batch, size_t k) {
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    uint32_t achievedCheckpoint = batch->m_checkpointHit[k];
+#else
+    uint32_t achievedCheckpoint = BIT_COUNT(batch->m_checkpointHit[k]);
+#endif
+    return batch->m_endTrack[k] == game->m_endTrack && achievedCheckpoint >= static_cast<uint32_t>(Board::checkpointAmount);
+}
+
+// Functions taking std::true_type only run on boards whose offset space is solved, std::false_type is their stand-in
+template <typename Board>
+using OffsetSpaceSolvedTag = std::integral_constant<bool, Board::isOffsetSpaceSolved>;
+
+// How advice offsets are found, drawn from the solved offset space, rejection sampled, or on wide boards walked
+// from the offsets the end track is planted on
+enum AdviceSearch { SOLVED_ADVICE_SEARCH, SAMPLED_ADVICE_SEARCH, PLANTED_ADVICE_SEARCH };
+typedef std::integral_constant<AdviceSearch, SOLVED_ADVICE_SEARCH> SolvedAdviceSearch;
+typedef std::integral_constant<AdviceSearch, SAMPLED_ADVICE_SEARCH> SampledAdviceSearch;
+typedef std::integral_constant<AdviceSearch, PLANTED_ADVICE_SEARCH> PlantedAdviceSearch;
+
+template <typename Board>
+using AdviceSearchTag = std::integral_constant<AdviceSearch, Board::isOffsetSpaceSolved ? SOLVED_ADVICE_SEARCH :
+    (Board::isWideBoard ? PLANTED_ADVICE_SEARCH : SAMPLED_ADVICE_SEARCH)>;
+
+#ifdef OFFSET_LOOKUP_TABLE
+template <typename Board>
+void buildOffsetLookupTable (GameStatus<Board> *game, std::true_type) {
+    auto buildBegin = std::chrono::steady_clock::now();
+    OffsetSpaceTable<Board> *table = &game->m_offsetSpace;
+#ifdef OFFSET_SIGNATURE
+    // Compare each signature with the track holding checkpoint on each checkpoint position
+    int checkpointTrack[Board::checkpointAmount];
+    for (int i = 0; i < Board::checkpointAmount; ++i) {
+        checkpointTrack[i] = -1;
+        for (int j = 0; j < Board::trackAmount; ++j) {
+            if (game->m_trackStatusList[j].m_checkpoint & MASK_AT((i + 1) * Board::checkpointSpacing)) {
+                checkpointTrack[i] = j;
+            }
+        }
+    }
+    size_t solutionAmount = 0;
+    for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+        uint16_t signature = table->m_offsetSignature[tuple];
+        int achievedCheckpoint = 0;
+        for (int i = 0; i < Board::checkpointAmount; ++i) {
+            achievedCheckpoint += (static_cast<int>(SIGNATURE_TRACK(signature, i)) == checkpointTrack[i]) ? 1 : 0;
+        }
+        int endTrack = SIGNATURE_TRACK(signature, Board::checkpointAmount);
+        bool isComplete = (game->m_endTrack == static_cast<size_t>(endTrack)) && (achievedCheckpoint >= Board::checkpointAmount);
+        table->m_offsetLookupTable[tuple] = LOOKUP_ENTRY(endTrack, achievedCheckpoint, isComplete);
+        solutionAmount += isComplete ? 1 : 0;
+    }
+#else
+    // Checkpoint of every track on each position, bit t is track t
+    uint32_t checkpointColumn[Board::interleaveTrackPosAmount] = {};
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        for (int j = 0; j < Board::interleaveTrackPosAmount; ++j) {
+            checkpointColumn[j] |= ((game->m_trackStatusList[i].m_checkpoint >> j) & 1) << i;
+        }
+    }
+    // Achieved checkpoint before each position, only refreshed from the position where the trace changed
+    int achievedPrefix[Board::interleaveTrackPosAmount + 1] = {};
+    size_t solutionAmount = 0;
+    int maximumCheckpoint = 0;
+    enumerateOffsetSpace(game->m_railStatusList, [&] (size_t tuple, const GhostLegTrace<Board> *trace, int changedPos) {
+        for (int i = changedPos; i < Board::interleaveTrackPosAmount; ++i) {
+            achievedPrefix[i + 1] = achievedPrefix[i] + ((checkpointColumn[i] >> traceTrackAt(trace, i, game->m_startTrack)) & 1);
+        }
+        int endTrack = traceEndTrack(trace, game->m_startTrack);
+        int achievedCheckpoint = achievedPrefix[Board::interleaveTrackPosAmount];
+        bool isComplete = (game->m_endTrack == static_cast<size_t>(endTrack)) && (achievedCheckpoint >= Board::checkpointAmount);
+        table->m_offsetLookupTable[tuple] = LOOKUP_ENTRY(endTrack, achievedCheckpoint, isComplete);
+        solutionAmount += isComplete ? 1 : 0;
+        if (game->m_endTrack == static_cast<size_t>(endTrack)) {
+            maximumCheckpoint = std::max(maximumCheckpoint, achievedCheckpoint);
+        }
+    });
+  #ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    game->m_maximumCheckpoint = maximumCheckpoint;
+  #endif
+#endif
+    game->m_lookupSolutionAmount = solutionAmount;
+    game->m_lookupTuple = Board::offsetTupleAmount;
+    game->m_lookupBuildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildBegin).count();
+}
+
+template <typename Board>
+void buildOffsetLookupTable (GameStatus<Board> *game, std::false_type) {
+    game->m_lookupSolutionAmount = 0;
+    game->m_lookupTuple = Board::offsetTupleAmount;
+    game->m_lookupBuildTime = .0;
+}
+
+// Checkpoints of a bank board are regenerated from its solved offset space like those of a generated one
+template <typename Board>
+void solveBankOffsetSpace (GameStatus<Board> *game) {
+    if (game->m_bankCompleteSet) {
+        solveRestoredOffsetSpace(game, AdviceSearchTag<Board>());
+        game->m_bankCompleteSet = nullptr;
+    }
+}
+#endif
+
+template <typename Board>
+bool isAdviceOffsetReachEnd (GameStatus<Board> *game) {
+    buildSwapLayer(game->m_railStatusList, &RailStatus<Board>::m_adviceCompleteOffset, game->m_adviceSwapLayer);
+    return static_cast<size_t>(composeEndTrack<Board>(game->m_adviceSwapLayer, game->m_startTrack)) == game->m_endTrack;
+}
+
+template <typename Board>
+void updateAdviceAnswerTrackPath (GameStatus<Board> *game) {
+    buildSwapLayer(game->m_railStatusList, &RailStatus<Board>::m_adviceCompleteOffset, game->m_adviceSwapLayer);
+    traceSwapLayer(game->m_adviceSwapLayer, &game->m_adviceTrace);
+    for (int i = 0; i < Board::interleaveTrackPosAmount; ++i) {
+        game->m_adviceAnswerTrackPath[i] = traceTrackAt(&game->m_adviceTrace, i, game->m_startTrack);
+    }
+}
+
+// Draw uniformly from the solution set
+template <typename Board>
+bool drawAdviceOffset (GameStatus<Board> *game, RandomEngine *engine, SolvedAdviceSearch) {
+    // NOTICE: game->m_offsetSpace.m_solutionSet should be solved by solveOffsetSpace() first
+    if (game->m_solutionAmount == 0) {
+        return false;
+    }
+    size_t n = randomBelow(engine, game->m_solutionAmount);
+    size_t offsetList[Board::railAmount];
+    decodeOffsetTuple<Board>(selectSolution(game->m_offsetSpace.m_solutionSet, n), offsetList);
+    for (int i = 0; i < Board::railAmount; ++i) {
+        game->m_railStatusList[i].m_adviceCompleteOffset = offsetList[i];
+    }
+    return true;
+}
+
+// Offset space is too large to solve, draw uniform tuples until one reaches end track, which is as uniform
+// over the solutions. Advice offsets are left as they were if none is found within ADVICE_DRAW_LIMIT draws.
+#define ADVICE_DRAW_LIMIT 4096
+template <typename Board>
+bool drawAdviceOffset (GameStatus<Board> *game, RandomEngine *engine, SampledAdviceSearch) {
+    RailStatus<Board> railList[Board::railAmount];
+    memcpy(railList, game->m_railStatusList, sizeof(railList));
+    for (int draw = 0; draw < ADVICE_DRAW_LIMIT; ++draw) {
+        for (int i = 0; i < Board::railAmount; ++i) {
+            railList[i].m_adviceCompleteOffset = randomBelow(engine, Board::offsetLevelAmount);
+        }
+        buildSwapLayer(railList, &RailStatus<Board>::m_adviceCompleteOffset, game->m_adviceSwapLayer);
+        game->m_adviceDrawAmount++;
+        if (static_cast<size_t>(composeEndTrack<Board>(game->m_adviceSwapLayer, game->m_startTrack)) == game->m_endTrack) {
+            for (int i = 0; i < Board::railAmount; ++i) {
+                game->m_railStatusList[i].m_adviceCompleteOffset = railList[i].m_adviceCompleteOffset;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// A random tuple almost never reaches a given end track on wide boards, so each rail in turn moves to a random
+// offset and keeps it only if start track still reaches end track. The offsets the end track was planted on
+// (isBoardSolvable()) are always an answer to start from.
+template <typename Board>
+bool drawAdviceOffset (GameStatus<Board> *game, RandomEngine *engine, PlantedAdviceSearch) {
+    typename Board::SwapLayer *swapLayer = game->m_adviceSwapLayer;
+    buildSwapLayer(game->m_railStatusList, &RailStatus<Board>::m_adviceCompleteOffset, swapLayer);
+    for (int i = 0; i < Board::railAmount; ++i) {
+        RailStatus<Board> *rail = &game->m_railStatusList[i];
+        size_t nextOffset = randomBelow(engine, Board::offsetLevelAmount);
+        removeRailSwapLayer(rail->m_activeBar, rail->m_adviceCompleteOffset, i, swapLayer);
+        addRailSwapLayer(rail->m_activeBar, nextOffset, i, swapLayer);
+        game->m_adviceDrawAmount++;
+        if (static_cast<size_t>(composeEndTrack<Board>(swapLayer, game->m_startTrack)) == game->m_endTrack) {
+            rail->m_adviceCompleteOffset = nextOffset;
+        } else {
+            removeRailSwapLayer(rail->m_activeBar, nextOffset, i, swapLayer);
+            addRailSwapLayer(rail->m_activeBar, rail->m_adviceCompleteOffset, i, swapLayer);
+        }
+    }
+    return true;
+}
+
+template <typename Board>
+bool findAdmissibleAnswer (GameStatus<Board> *game, RandomEngine *engine) {
+    // this will update game->m_railStatusList->m_adviceCompleteOffset and game->m_adviceAnswerTrackPath
+    // Previous advice offsets are kept when no new one is drawn, so path follows them whenever they still reach end
+    bool isDrawn = drawAdviceOffset(game, engine, AdviceSearchTag<Board>());
+    if (isDrawn || isAdviceOffsetReachEnd(game)) {
+        updateAdviceAnswerTrackPath(game);
+    }
+    return isDrawn;
+}
+
+// Whether rail swaps on pos under offset, pos must have the parity (i & 1) ^ 1 rail i swaps on
+template <typename Board>
+bool isRailSwapAt (const RailStatus<Board> *rail, int offset, int pos) {
+    int bar = pos / 2 - offset;
+    return bar >= 0 && bar < Board::barAmount && isMaskBitSet(rail->m_activeBar, bar);
+}
+
+template <typename Board>
+bool canRailSwapAt (const RailStatus<Board> *rail, int pos) {
+    for (int offset = 0; offset < Board::offsetLevelAmount; ++offset) {
+        if (isRailSwapAt<Board>(rail, offset, pos)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Only one of the rails beside track can swap on pos, -1 if that one is off the board
+template <typename Board>
+int railBesideTrack (int track, int pos) {
+    int rail = ((track + 1) & 1) == ((pos & 1) ^ 1) ? track - 1 : track;
+    return rail < Board::railAmount ? rail : -1;
+}
+
+#ifdef ONE_SET_CHECKPOINT_GENERATION
+template <typename Board>
+void useAdmissibleAnswerToTagCheckpoint(GameStatus<Board> *game) {
+    // m_adviceAnswerTrackPath is the trace of current advice offsets
+    for (int globalTrackTestPos = Board::checkpointSpacing; globalTrackTestPos < Board::interleaveTrackPosAmount; globalTrackTestPos += Board::checkpointSpacing) {
+        int currentTrack = game->m_adviceAnswerTrackPath[globalTrackTestPos];
+        setMaskBit(&game->m_trackStatusList[currentTrack].m_checkpoint, globalTrackTestPos);
+    }
+}
+
+// Distance of a state is the positions left plus the track changes a path needs, a track may only change on
+// positions some offset of the rail beside it puts a bar. Checkpoint distance aims at the checkpoint of the
+// first checkpoint position after p (end track after the last one), end track distance at end track through
+// every checkpoint left.
+#define DISTANCE_UNREACHABLE UINT16_MAX
+
+template <typename Board>
+void updateDistanceField (GameStatus<Board> *game) {
+    // Active bars of each rail below bar i, rail swaps on pos under some offset if a bar lies in [pos / 2 - barAmount, pos / 2]
+    for (int i = 0; i < Board::railAmount; ++i) {
+        game->m_barPrefix[i][0] = 0;
+        for (int j = 0; j < Board::barAmount; ++j) {
+            game->m_barPrefix[i][j + 1] = game->m_barPrefix[i][j] + (isMaskBitSet(game->m_railStatusList[i].m_activeBar, j) ? 1 : 0);
+        }
+    }
+    // Target row of the segment being built, end track past the last position
+    uint16_t target[Board::trackAmount];
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        target[i] = static_cast<size_t>(i) == game->m_endTrack ? 0 : DISTANCE_UNREACHABLE;
+        game->m_checkpointDistance[Board::interleaveTrackPosAmount][i] = target[i];
+        game->m_endTrackDistance[Board::interleaveTrackPosAmount][i] = target[i];
+    }
+    int targetPos = Board::interleaveTrackPosAmount;
+    int targetTrack = static_cast<int>(game->m_endTrack);
+    const uint16_t *next = target;
+    for (int j = Board::interleaveTrackPosAmount - 1; j >= 0; --j) {
+        int lowBar = std::max(j / 2 - Board::barAmount, 0);
+        int highBar = std::min(j / 2, Board::barAmount - 1);
+        int best[Board::trackAmount];
+        for (int i = 0; i < Board::trackAmount; ++i) {
+            best[i] = next[i];
+        }
+        // Only rails of parity (j & 1) ^ 1 swap on j, each one joins the tracks on its both sides
+        for (int i = (j & 1) ^ 1; i < Board::railAmount; i += 2) {
+            if (game->m_barPrefix[i][highBar + 1] > game->m_barPrefix[i][lowBar]) {
+                best[i] = std::min(best[i], next[i + 1] + 1);
+                best[i + 1] = std::min(best[i + 1], next[i] + 1);
+            }
+        }
+        int targetEndTrackDistance = game->m_endTrackDistance[targetPos][targetTrack];
+        for (int i = 0; i < Board::trackAmount; ++i) {
+            bool isReachable = best[i] < DISTANCE_UNREACHABLE && targetEndTrackDistance < DISTANCE_UNREACHABLE;
+            game->m_checkpointDistance[j][i] = best[i] < DISTANCE_UNREACHABLE ? best[i] + 1 : DISTANCE_UNREACHABLE;
+            game->m_endTrackDistance[j][i] = isReachable ? best[i] + 1 + targetEndTrackDistance : DISTANCE_UNREACHABLE;
+        }
+        if (j > 0 && j % Board::checkpointSpacing == 0) {
+            // Positions before j aim at the checkpoint on j
+            for (int i = 0; i < Board::trackAmount; ++i) {
+                bool isCheckpoint = isMaskBitSet(game->m_trackStatusList[i].m_checkpoint, j);
+                target[i] = isCheckpoint ? 0 : DISTANCE_UNREACHABLE;
+                targetTrack = isCheckpoint ? i : targetTrack;
+            }
+            targetPos = j;
+            next = target;
+        } else {
+            next = game->m_checkpointDistance[j];
+        }
+    }
+}
+
+template <typename Board>
+void updateCheckpoint (TrackStatus<Board> *trackList, GameStatus<Board> *game, RandomEngine *engine) {
+#ifdef OFFSET_LOOKUP_TABLE
+    solveBankOffsetSpace(game);
+#endif
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        trackList[i].m_checkpoint = typename Board::PositionMask();
+    }
+    findAdmissibleAnswer(game, engine);
+    useAdmissibleAnswerToTagCheckpoint(game);
+    updateDistanceField(game);
+#ifdef OFFSET_LOOKUP_TABLE
+    buildOffsetLookupTable(game, OffsetSpaceSolvedTag<Board>());
+#endif
+    game->m_isTraceValid = false;
+    game->m_isProgressStale = true;
+}
+#endif
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+template <typename Board>
+int adviceAchievedCheckpoint (const GameStatus<Board> *game) {
+    int achievedCheckpoint = 0;
+    for (int i = 0; i < Board::interleaveTrackPosAmount; ++i) {
+        achievedCheckpoint += isMaskBitSet(game->m_trackStatusList[game->m_adviceAnswerTrackPath[i]].m_checkpoint, i) ? 1 : 0;
+    }
+    return achievedCheckpoint;
+}
+
+// Depth first search over offset tuples for the path of start track. A rail's offset is only branched on when
+// the path first reaches a position that rail can swap on, rails the path never meets keep their advice offsets.
+// Branches are cut once the checkpoints passed plus the most the rest of the board could give fall short.
+template <typename Board>
+struct AnswerSearch {
+    const GameStatus<Board> *m_game;
+
+    // Checkpoint of every track on each position, bit t is track t
+    uint32_t m_checkpointColumn[Board::interleaveTrackPosAmount];
+
+    // Most checkpoints from entering position p on track t to end track, when every rail may swap wherever
+    // some offset puts a bar, ANSWER_UNREACHABLE if end track can't be reached at all
+    int m_bound[Board::interleaveTrackPosAmount + 1][Board::trackAmount];
+
+    // Offset of each rail, -1 until the path meets it
+    int m_offset[Board::railAmount];
+
+    size_t m_nodeAmount;
+
+    size_t m_nodeLimit;
+
+};
+
+#define ANSWER_UNREACHABLE (-(1 << 20))
+// Offset branchings a search on an unsolved offset space may take before the checkpoint set is repaired
+#define ANSWER_SEARCH_NODE_LIMIT (1 << 14)
+
+template <typename Board>
+void initAnswerSearch (AnswerSearch<Board> *search, const GameStatus<Board> *game, size_t nodeLimit) {
+    search->m_game = game;
+    for (int j = 0; j < Board::interleaveTrackPosAmount; ++j) {
+        search->m_checkpointColumn[j] = 0;
+        for (int i = 0; i < Board::trackAmount; ++i) {
+            search->m_checkpointColumn[j] |= (isMaskBitSet(game->m_trackStatusList[i].m_checkpoint, j) ? 1u : 0u) << i;
+        }
+    }
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        search->m_bound[Board::interleaveTrackPosAmount][i] = static_cast<size_t>(i) == game->m_endTrack ? 0 : ANSWER_UNREACHABLE;
+    }
+    for (int j = Board::interleaveTrackPosAmount - 1; j >= 0; --j) {
+        for (int i = 0; i < Board::trackAmount; ++i) {
+            int best = search->m_bound[j + 1][i];
+            int rail = railBesideTrack<Board>(i, j);
+            if (rail >= 0 && canRailSwapAt<Board>(&game->m_railStatusList[rail], j)) {
+                best = std::max(best, search->m_bound[j + 1][rail == i ? i + 1 : i - 1]);
+            }
+            search->m_bound[j][i] = best <= ANSWER_UNREACHABLE ? ANSWER_UNREACHABLE : best + static_cast<int>((search->m_checkpointColumn[j] >> i) & 1);
+        }
+    }
+    for (int i = 0; i < Board::railAmount; ++i) {
+        search->m_offset[i] = -1;
+    }
+    search->m_nodeAmount = 0;
+    search->m_nodeLimit = nodeLimit;
+}
+
+// Follow the path from pos on track with achievedCheckpoint passed so far
+template <typename Board>
+bool searchAnswer (AnswerSearch<Board> *search, int pos, int track, int achievedCheckpoint) {
+    const RailStatus<Board> *railList = search->m_game->m_railStatusList;
+    for (; pos < Board::interleaveTrackPosAmount; ++pos) {
+        if (achievedCheckpoint + search->m_bound[pos][track] < Board::checkpointAmount) {
+            return false;
+        }
+        int rail = railBesideTrack<Board>(track, pos);
+        bool isSwapped = false;
+        if (rail >= 0) {
+            if (search->m_offset[rail] < 0 && canRailSwapAt<Board>(&railList[rail], pos)) {
+                for (int offset = 0; offset < Board::offsetLevelAmount && search->m_nodeAmount < search->m_nodeLimit; ++offset) {
+                    search->m_nodeAmount++;
+                    search->m_offset[rail] = offset;
+                    if (searchAnswer(search, pos, track, achievedCheckpoint)) {
+                        return true;
+                    }
+                }
+                search->m_offset[rail] = -1;
+                return false;
+            }
+            isSwapped = search->m_offset[rail] >= 0 && isRailSwapAt<Board>(&railList[rail], search->m_offset[rail], pos);
+        }
+        achievedCheckpoint += static_cast<int>((search->m_checkpointColumn[pos] >> track) & 1);
+        if (isSwapped) {
+            track = rail == track ? track + 1 : track - 1;
+        }
+    }
+    return static_cast<size_t>(track) == search->m_game->m_endTrack && achievedCheckpoint >= Board::checkpointAmount;
+}
+
+// Return whether some tuple reaching end track passes checkpointAmount checkpoints and make it the advice offsets,
+// the drawn advice offsets are kept if they already do
+template <typename Board>
+bool searchAdviceAnswer (GameStatus<Board> *game, size_t nodeLimit) {
+    if (adviceAchievedCheckpoint(game) >= Board::checkpointAmount) {
+        return true;
+    }
+    AnswerSearch<Board> search;
+    initAnswerSearch(&search, game, nodeLimit);
+    if (!searchAnswer(&search, 0, static_cast<int>(game->m_startTrack), 0)) {
+        return false;
+    }
+    for (int i = 0; i < Board::railAmount; ++i) {
+        if (search.m_offset[i] >= 0) {
+            game->m_railStatusList[i].m_adviceCompleteOffset = search.m_offset[i];
+        }
+    }
+    updateAdviceAnswerTrackPath(game);
+    return true;
+}
+
+// Search is exhaustive on solved offset spaces, at most 17^4 leaves before pruning
+template <typename Board>
+bool isAnswerExist (GameStatus<Board> *game, SolvedAdviceSearch) {
+    return searchAdviceAnswer(game, SIZE_MAX);
+}
+
+template <typename Board>
+bool isAnswerExist (GameStatus<Board> *game, SampledAdviceSearch) {
+    return searchAdviceAnswer(game, ANSWER_SEARCH_NODE_LIMIT);
+}
+
+// Wide board paths meet too many rails to search, only advice path is checked
+template <typename Board>
+bool isAnswerExist (GameStatus<Board> *game, PlantedAdviceSearch) {
+    return adviceAchievedCheckpoint(game) >= Board::checkpointAmount;
+}
+
+// Tag random positions of advice path until it passes checkpointAmount checkpoints, so the set stays random
+// off the path and the repair never loops on redraws
+template <typename Board>
+void repairCheckpoint (GameStatus<Board> *game, RandomEngine *engine) {
+    static_assert(Board::checkpointAmount <= Board::interleaveTrackPosAmount, "Advice path must be able to pass every checkpoint");
+    int missingCheckpoint = Board::checkpointAmount - adviceAchievedCheckpoint(game);
+    while (missingCheckpoint > 0) {
+        int pos = static_cast<int>(randomBelow(engine, Board::interleaveTrackPosAmount));
+        TrackStatus<Board> *track = &game->m_trackStatusList[game->m_adviceAnswerTrackPath[pos]];
+        if (!isMaskBitSet(track->m_checkpoint, pos)) {
+            setMaskBit(&track->m_checkpoint, pos);
+            missingCheckpoint--;
+        }
+    }
+}
+
+template <typename Board>
+void updateCheckpoint (TrackStatus<Board> *trackList, GameStatus<Board> *game, RandomEngine *engine) {
+#ifdef OFFSET_LOOKUP_TABLE
+    solveBankOffsetSpace(game);
+#endif
+    auto generateBegin = std::chrono::steady_clock::now();
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        trackList[i].m_checkpoint = randomBernoulliMask<typename Board::PositionMask>(engine, CHECKPOINT_GENERATE_PROBABILITY);
+    }
+    // Advice offsets reach end track, the check moves them to an answer passing enough checkpoints if there is one
+    findAdmissibleAnswer(game, engine);
+    if (!isAnswerExist(game, AdviceSearchTag<Board>())) {
+        repairCheckpoint(game, engine);
+        game->m_checkpointRepairTime++;
+    }
+    game->m_checkpointGenerateTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - generateBegin).count();
+    game->m_maximumCheckpoint = adviceAchievedCheckpoint(game);
+#ifdef OFFSET_LOOKUP_TABLE
+    buildOffsetLookupTable(game, OffsetSpaceSolvedTag<Board>());
+#endif
+    game->m_isTraceValid = false;
+    game->m_isProgressStale = true;
+}
+#endif
+
+template <typename Board>
+void generateCheckpoint (GameStatus<Board> *game, RandomEngine *engine) {
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        game->m_trackStatusList[i] = TrackStatus<Board>();
+    }
+    updateCheckpoint(game->m_trackStatusList, game, engine);
+}
+
+#ifdef CHECKPOINT_TRIGGER_EVENT
+template <typename Board>
+void updateTriggerCheckpoint (GameStatus<Board> *game, float triggerCheckpointGenProb, RandomEngine *engine) {
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        game->m_trackStatusList[i].m_triggerCheckpoint = game->m_trackStatusList[i].m_checkpoint & randomBernoulliMask<typename Board::PositionMask>(engine, triggerCheckpointGenProb);
+    }
+    game->m_isTraceValid = false;
+    game->m_isProgressStale = true;
+}
+#endif
+
+// Return whether current rails have any answer, solving the offset space on the way
+template <typename Board>
+bool isBoardSolvable (GameStatus<Board> *game, RandomEngine *, SolvedAdviceSearch) {
+#ifdef OFFSET_SIGNATURE
+    uint16_t *signature = game->m_offsetSpace.m_offsetSignature;
+#else
+    uint16_t *signature = nullptr;
+#endif
+    game->m_solutionAmount = solveOffsetSpace(game->m_railStatusList, game->m_startTrack, game->m_endTrack, game->m_offsetSpace.m_solutionSet, signature);
+    return game->m_solutionAmount > 0;
+}
+
+template <typename Board>
+bool isBoardSolvable (GameStatus<Board> *game, RandomEngine *engine, SampledAdviceSearch) {
+    return drawAdviceOffset(game, engine, SampledAdviceSearch());
+}
+
+// End track is replaced by where random advice offsets lead start track, so wide boards always have an answer
+template <typename Board>
+bool isBoardSolvable (GameStatus<Board> *game, RandomEngine *engine, PlantedAdviceSearch) {
+    for (int i = 0; i < Board::railAmount; ++i) {
+        game->m_railStatusList[i].m_adviceCompleteOffset = randomBelow(engine, Board::offsetLevelAmount);
+    }
+    buildSwapLayer(game->m_railStatusList, &RailStatus<Board>::m_adviceCompleteOffset, game->m_adviceSwapLayer);
+    game->m_endTrack = composeEndTrack<Board>(game->m_adviceSwapLayer, game->m_startTrack);
+    return true;
+}
+
+// Generate the next board in the storage of a finished one, nothing is allocated once the lazily built tables exist
+template <typename Board>
+void regenerateGame (GameStatus<Board> *game, RandomEngine *engine) {
+    static_assert(std::is_trivially_destructible<GameStatus<Board> >::value, "Board storage is reused without destruction");
+    // Value initialization resets every field and statistic as a newly allocated board has them
+    new (game) GameStatus<Board>();
+    game->m_startTrack = randomBelow(engine, Board::railAmount);
+    game->m_endTrack = randomBelow(engine, Board::railAmount);
+    generateGhostLegGraph<Board>(game->m_railStatusList, engine, &game->m_railRegenerateTime);
+    // Board without any answer is regenerated instead of searching for advice offsets forever
+    while (!isBoardSolvable(game, engine, AdviceSearchTag<Board>())) {
+        generateGhostLegGraph<Board>(game->m_railStatusList, engine, &game->m_railRegenerateTime);
+        game->m_unsolvableRegenerateTime++;
+    }
+    generateCheckpoint(game, engine);
+#ifdef CHECKPOINT_TRIGGER_EVENT
+    updateTriggerCheckpoint(game, TRIGGER_CHECKPOINT_PROBABILITY, engine);
+#endif
+    game->m_progressBar = .0f;
+}
+
+template <typename Board>
+GameStatus<Board> *generateGame(RandomEngine *engine) {
+    GameStatus<Board> *game = new GameStatus<Board>;
+    regenerateGame(game, engine);
+    return game;
+}
+
+template <typename Board>
+void solveRestoredOffsetSpace (GameStatus<Board> *game, SolvedAdviceSearch) {
+    isBoardSolvable(game, nullptr, SolvedAdviceSearch());
+}
+
+// Boards whose offset space isn't solved keep no table of it
+template <typename Board, typename Search>
+void solveRestoredOffsetSpace (GameStatus<Board> *, Search) {
+}
+
+// Tables generation derives from rails, tracks and advice offsets, for a board restored from only those
+template <typename Board>
+void rebuildGameTable (GameStatus<Board> *game) {
+    solveRestoredOffsetSpace(game, AdviceSearchTag<Board>());
+    updateAdviceAnswerTrackPath(game);
+#ifdef ONE_SET_CHECKPOINT_GENERATION
+    updateDistanceField(game);
+#else
+    game->m_maximumCheckpoint = adviceAchievedCheckpoint(game);
+#endif
+#ifdef OFFSET_LOOKUP_TABLE
+    buildOffsetLookupTable(game, OffsetSpaceSolvedTag<Board>());
+#endif
+    game->m_isTraceValid = false;
+    game->m_isProgressStale = true;
+}
+
+template <typename Board>
+void destroyGame (GameStatus<Board> *game) {
+    delete game;
+}
+
+template <typename Board>
+float progressBarUpdate(GameStatus<Board> *game) {
+
+#ifdef ONE_SET_CHECKPOINT_GENERATION
+    // NOTICE: should called after updateCurrentTrace() refreshed m_currentTrackHistory and m_currentEndTrack
+    const int checkpointSpacing = Board::checkpointSpacing;
+    int latestAchievedCheckpoint = 0;
+    // Only the checkpoint position of each segment need to be visited
+    while ((latestAchievedCheckpoint + 1) * checkpointSpacing < Board::interleaveTrackPosAmount) {
+        int checkpointPos = (latestAchievedCheckpoint + 1) * checkpointSpacing;
+        if (!isMaskBitSet(game->m_trackStatusList[game->m_currentTrackHistory[checkpointPos]].m_checkpoint, checkpointPos)) {
+            break;
+        }
+        latestAchievedCheckpoint++;
+    }
+    // Current state is the deepest one of the segment on which current path can still reach next checkpoint,
+    // the segment runs to end track after the last checkpoint
+    int segmentBeginPos = latestAchievedCheckpoint * checkpointSpacing;
+    int globalTrackTestPos = segmentBeginPos + checkpointSpacing < Board::interleaveTrackPosAmount ? segmentBeginPos + checkpointSpacing - 1 : Board::interleaveTrackPosAmount;
+    int currentTrack = globalTrackTestPos < Board::interleaveTrackPosAmount ? game->m_currentTrackHistory[globalTrackTestPos] : game->m_currentEndTrack;
+    while (globalTrackTestPos > segmentBeginPos && game->m_checkpointDistance[globalTrackTestPos][currentTrack] == DISTANCE_UNREACHABLE) {
+        globalTrackTestPos--;
+        currentTrack = game->m_currentTrackHistory[globalTrackTestPos];
+    }
+  #ifdef CHECKPOINT_TO_CHECKPOINT_DISTANCE
+    // Share of the distance from last achieved checkpoint (start track before the first one) to next checkpoint
+    int remainingDistance = game->m_checkpointDistance[globalTrackTestPos][currentTrack];
+    int totalDistance = game->m_checkpointDistance[segmentBeginPos][game->m_currentTrackHistory[segmentBeginPos]];
+  #endif
+  #ifdef CHECKPOINT_TO_ENDTRACK_DISTANCE
+    // Share of the distance from start track to end track through every checkpoint
+    int remainingDistance = game->m_endTrackDistance[globalTrackTestPos][currentTrack];
+    int totalDistance = game->m_endTrackDistance[0][game->m_startTrack];
+  #endif
+    if (remainingDistance == DISTANCE_UNREACHABLE || totalDistance == DISTANCE_UNREACHABLE) {
+        game->m_progressBar = .0f;
+    } else {
+        game->m_progressBar = clamp(1.0f - static_cast<float>(remainingDistance) / std::max(totalDistance, 1), .0f, 1.0f);
+    }
+    game->m_debug = globalTrackTestPos;
+#endif
+
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+  #ifdef TO_MAXIMUM_CHECKPOINT_DISTANCE
+    // Share of the most checkpoints an answer passes
+    game->m_progressBar = clamp(static_cast<float>(game->m_achievedCheckpoint) / std::max(game->m_maximumCheckpoint, 1), .0f, 1.0f);
+  #endif
+#endif
+    return game->m_progressBar;
+}
+
+// Trace current rail offsets for track history, achieved checkpoint and end track. Only positions from
+// the first one a moved rail can swap on (before or after moving) are re-traced.
+template <typename Board>
+void updateCurrentTrace(GameStatus<Board> *game) {
+    int firstChangedPos = Board::interleaveTrackPosAmount;
+    if (!game->m_isTraceValid) {
+        buildSwapLayer(game->m_railStatusList, &RailStatus<Board>::m_offset, game->m_swapLayer);
+        for (int i = 0; i < Board::railAmount; ++i) {
+            game->m_tracedOffset[i] = game->m_railStatusList[i].m_offset;
+        }
+        setIdentityOccupancy(&game->m_currentTrace.m_occupancy[0], Board::trackAmount);
+        game->m_achievedCheckpointPrefix[0] = 0;
+#ifdef CHECKPOINT_TRIGGER_EVENT
+        game->m_isTriggerCheckpointPrefix[0] = false;
+#endif
+        game->m_isTraceValid = true;
+        firstChangedPos = 0;
+    } else {
+        for (int i = 0; i < Board::railAmount; ++i) {
+            const RailStatus<Board> *rail = &game->m_railStatusList[i];
+            if (rail->m_offset != game->m_tracedOffset[i]) {
+                removeRailSwapLayer(rail->m_activeBar, game->m_tracedOffset[i], i, game->m_swapLayer);
+                addRailSwapLayer(rail->m_activeBar, rail->m_offset, i, game->m_swapLayer);
+                firstChangedPos = std::min(firstChangedPos, firstRailSwapPos<Board>(rail->m_activeBar, std::min(rail->m_offset, game->m_tracedOffset[i]), i));
+                game->m_tracedOffset[i] = rail->m_offset;
+            }
+        }
+    }
+    traceSwapLayerFrom(game->m_swapLayer, &game->m_currentTrace, firstChangedPos);
+    for (int globalTrackTestPos = firstChangedPos; globalTrackTestPos < Board::interleaveTrackPosAmount; ++globalTrackTestPos) {
+        int currentTrack = traceTrackAt(&game->m_currentTrace, globalTrackTestPos, game->m_startTrack);
+        // For debug purpose
+        game->m_currentTrackHistory[globalTrackTestPos] = currentTrack;
+
+        game->m_achievedCheckpointPrefix[globalTrackTestPos + 1] = game->m_achievedCheckpointPrefix[globalTrackTestPos] + (isMaskBitSet(game->m_trackStatusList[currentTrack].m_checkpoint, globalTrackTestPos) ? 1 : 0);
+
+#ifdef CHECKPOINT_TRIGGER_EVENT
+        game->m_isTriggerCheckpointPrefix[globalTrackTestPos + 1] = std::max(game->m_isTriggerCheckpointPrefix[globalTrackTestPos], isMaskBitSet(game->m_trackStatusList[currentTrack].m_triggerCheckpoint, globalTrackTestPos));
+#endif
+    }
+    game->m_achievedCheckpoint = game->m_achievedCheckpointPrefix[Board::interleaveTrackPosAmount];
+#ifdef CHECKPOINT_TRIGGER_EVENT
+    game->m_isTriggerCheckpoint = game->m_isTriggerCheckpointPrefix[Board::interleaveTrackPosAmount];
+#endif
+    game->m_currentEndTrack = traceEndTrack(&game->m_currentTrace, game->m_startTrack);
+
+    game->m_retracedPosition = Board::interleaveTrackPosAmount - firstChangedPos;
+    game->m_retracedPositionTotal += game->m_retracedPosition;
+    game->m_traceUpdateAmount++;
+}
+
+#ifdef OFFSET_LOOKUP_TABLE
+// Only a table read, nothing is done if input and checkpoints are unchanged since last lookup
+template <typename Board>
+void updateGameInfoByLookup(GameStatus<Board> *game, std::true_type) {
+    size_t tuple = encodeRailOffset(game->m_railStatusList, &RailStatus<Board>::m_offset);
+    if (tuple == game->m_lookupTuple) {
+        return;
+    }
+    game->m_lookupTuple = tuple;
+    if (game->m_bankCompleteSet) {
+        // End track and achieved checkpoint of a bank board wait for the trace as well
+        game->m_isComplete = (game->m_bankCompleteSet[tuple / 64] & MASK_AT(tuple % 64)) ? true : false;
+    } else {
+        uint8_t entry = game->m_offsetSpace.m_offsetLookupTable[tuple];
+        game->m_currentEndTrack = LOOKUP_END_TRACK(entry);
+        game->m_achievedCheckpoint = LOOKUP_ACHIEVED_CHECKPOINT(entry);
+        game->m_isComplete = LOOKUP_IS_COMPLETE(entry);
+    }
+    // Track history and progress bar are traced by refreshGameProgress() once a frame needs them
+    game->m_isProgressStale = true;
+}
+#endif
+
+// Offset space without lookup table is judged by the trace
+template <typename Board>
+void updateGameInfoByLookup(GameStatus<Board> *game, std::false_type) {
+    updateCurrentTrace(game);
+    game->m_isComplete = (game->m_endTrack == static_cast<size_t>(game->m_currentEndTrack)) && (game->m_achievedCheckpoint >= Board::checkpointAmount);
+    progressBarUpdate(game);
+}
+
+template <typename Board>
+void updateGameInfo(GameStatus<Board> *game) {
+#ifdef OFFSET_LOOKUP_TABLE
+    updateGameInfoByLookup(game, OffsetSpaceSolvedTag<Board>());
+#else
+    updateGameInfoByLookup(game, std::false_type());
+#endif
+}
+
+// Trace track history and progress bar left behind by a table lookup, no-op if they are up to date
+template <typename Board>
+void refreshGameProgress(GameStatus<Board> *game) {
+    if (!game->m_isProgressStale) {
+        return;
+    }
+    updateCurrentTrace(game);
+    progressBarUpdate(game);
+    game->m_isProgressStale = false;
+}
+
+// First board of a session, a board complete at initial offsets is regenerated
+template <typename Board>
+GameStatus<Board> *generateFirstGame (RandomEngine *engine) {
+    GameStatus<Board> *game = generateGame<Board>(engine);
+    updateGameInfo(game);
+    while(game->m_isComplete) {
+        regenerateGame(game, engine);
+        updateGameInfo(game);
+    }
+    return game;
+}
+
+void initCheckpointTimer (TimerScheduler *scheduler, std::chrono::steady_clock::time_point startTime) {
+#ifdef TIME_TRIGGER_EVENT
+    std::chrono::steady_clock::duration interval = std::chrono::seconds(TIME_TRIGGER_INTERVAL);
+    scheduleTimer(scheduler, TIME_TRIGGER_TIMER, startTime + interval, interval);
+#endif
+}
+
+// Return true if checkpoints are regenerated
+template <typename Board>
+bool eventDrivenCheckpointUpdate(TimerScheduler *scheduler, GameStatus<Board> *game, RandomEngine *engine, std::chrono::steady_clock::time_point now) {
+#ifdef CHECKPOINT_TRIGGER_EVENT
+    // NOTICE: should called after updateGameInfo()
+    refreshGameProgress(game);
+    // Only the rising edge is scheduled, staying on triggered checkpoint doesn't regenerate again
+    if (game->m_isTriggerCheckpoint && !game->m_isTriggerCheckpointScheduled) {
+        scheduleTimer(scheduler, CHECKPOINT_TRIGGER_TIMER, now, std::chrono::steady_clock::duration::zero());
+    }
+    game->m_isTriggerCheckpointScheduled = game->m_isTriggerCheckpoint;
+#endif
+
+    // Timers expired together share one regeneration
+    bool isRegenerated = false;
+    TimerType type;
+    while (popExpiredTimer(scheduler, now, &type)) {
+        isRegenerated = isRegenerated || type != IDLE_REPORT_TIMER;
+    }
+    if (isRegenerated) {
+        updateCheckpoint(game->m_trackStatusList, game, engine);
+    }
+    return isRegenerated;
+}
+
+// Frame
+template <typename Board>
+GameFrame<Board> *beginGameFrame (FrameBuffer<Board> *buffer) {
+    return &buffer->m_frame[buffer->m_back];
+}
+
+template <typename Board>
+void publishGameFrame (FrameBuffer<Board> *buffer) {
+    buffer->m_frame[buffer->m_back].m_version = ++buffer->m_version;
+    uint8_t previousMiddle = buffer->m_middle.exchange(buffer->m_back | FRESH_FRAME_BIT, std::memory_order_acq_rel);
+    buffer->m_back = previousMiddle & FRAME_SLOT_MASK;
+    if (previousMiddle & FRESH_FRAME_BIT) {
+        buffer->m_droppedAmount++;
+    }
+    buffer->m_publishAmount++;
+}
+
+// Return latest frame, or nullptr if nothing is published since last consume
+template <typename Board>
+const GameFrame<Board> *consumeGameFrame (FrameBuffer<Board> *buffer) {
+    if (!(buffer->m_middle.load(std::memory_order_relaxed) & FRESH_FRAME_BIT)) {
+        return nullptr;
+    }
+    uint8_t previousMiddle = buffer->m_middle.exchange(buffer->m_front, std::memory_order_acq_rel);
+    buffer->m_front = previousMiddle & FRAME_SLOT_MASK;
+    buffer->m_consumeAmount++;
+    return &buffer->m_frame[buffer->m_front];
+}
+
+#ifdef OFFSET_HINT
+// Hint
+// Multi-source breadth first search from every complete tuple over the offset lattice, a tuple's neighbours
+// are one rail one offset level away
+template <typename Board>
+void solveOffsetHint (const uint64_t *completeSet, HintTable<Board> *table) {
+    size_t stride[Board::railAmount];
+    for (int i = 0; i < Board::railAmount; ++i) {
+        stride[i] = i > 0 ? stride[i - 1] * Board::offsetLevelAmount : 1;
+    }
+    std::vector<uint32_t> frontier;
+    std::vector<uint32_t> nextFrontier;
+    for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+        bool isComplete = (completeSet[tuple / 64] >> (tuple % 64)) & 1;
+        table->m_distance[tuple] = isComplete ? 0 : HINT_UNREACHABLE;
+        if (isComplete) {
+            frontier.push_back(static_cast<uint32_t>(tuple));
+        }
+    }
+    for (int distance = 1; !frontier.empty(); ++distance) {
+        nextFrontier.clear();
+        for (uint32_t tuple : frontier) {
+            for (int i = 0; i < Board::railAmount; ++i) {
+                size_t level = tuple / stride[i] % Board::offsetLevelAmount;
+                if (level > 0 && table->m_distance[tuple - stride[i]] == HINT_UNREACHABLE) {
+                    table->m_distance[tuple - stride[i]] = static_cast<uint8_t>(distance);
+                    nextFrontier.push_back(static_cast<uint32_t>(tuple - stride[i]));
+                }
+                if (level + 1 < Board::offsetLevelAmount && table->m_distance[tuple + stride[i]] == HINT_UNREACHABLE) {
+                    table->m_distance[tuple + stride[i]] = static_cast<uint8_t>(distance);
+                    nextFrontier.push_back(static_cast<uint32_t>(tuple + stride[i]));
+                }
+            }
+        }
+        frontier.swap(nextFrontier);
+    }
+}
+
+// Longest run of one rail's steps each one step closer to a complete tuple
+template <typename Board>
+void findOffsetHint (const HintTable<Board> *table, const RailStatus<Board> *railList, OffsetHint *hint) {
+    size_t tuple = encodeRailOffset(railList, &RailStatus<Board>::m_offset);
+    hint->m_distance = table->m_distance[tuple];
+    hint->m_rail = -1;
+    hint->m_step = 0;
+    if (hint->m_distance == 0 || hint->m_distance == HINT_UNREACHABLE) {
+        return;
+    }
+    size_t stride = 1;
+    for (int i = 0; i < Board::railAmount; ++i, stride *= Board::offsetLevelAmount) {
+        for (int direction = -1; direction <= 1; direction += 2) {
+            int level = static_cast<int>(railList[i].m_offset);
+            size_t stepTuple = tuple;
+            int step = 0;
+            while (level + direction >= 0 && level + direction < Board::offsetLevelAmount) {
+                size_t nextTuple = direction > 0 ? stepTuple + stride : stepTuple - stride;
+                if (table->m_distance[nextTuple] + 1 != table->m_distance[stepTuple]) {
+                    break;
+                }
+                stepTuple = nextTuple;
+                level += direction;
+                step++;
+            }
+            if (step > std::abs(hint->m_step)) {
+                hint->m_rail = i;
+                hint->m_step = step * direction;
+            }
+        }
+    }
+}
+
+// Hand complete tuples of current checkpoints to the solver thread, called whenever checkpoints are regenerated
+template <typename Board>
+void requestOffsetHint (HintSolver<Board> *solver, const GameStatus<Board> *game, std::true_type) {
+    {
+        std::lock_guard<std::mutex> lock(solver->m_mutex);
+        if (game->m_bankCompleteSet) {
+            memcpy(solver->m_completeSet, game->m_bankCompleteSet, sizeof(solver->m_completeSet));
+        } else {
+            memset(solver->m_completeSet, 0, sizeof(solver->m_completeSet));
+            for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+                if (LOOKUP_IS_COMPLETE(game->m_offsetSpace.m_offsetLookupTable[tuple])) {
+                    solver->m_completeSet[tuple / 64] |= uint64_t(1) << (tuple % 64);
+                }
+            }
+        }
+        solver->m_generation = ++solver->m_requestGeneration;
+    }
+    solver->m_condition.notify_one();
+}
+
+template <typename Board>
+void requestOffsetHint (HintSolver<Board> *, const GameStatus<Board> *, std::false_type) {
+}
+
+// Solver thread, a request posted while solving is taken next, the ones in between are skipped
+template <typename Board>
+void startOffsetHintSolver (HintSolver<Board> *solver, GameEventQueue<Board> *queue, std::true_type) {
+    std::thread([solver, queue] () {
+        std::vector<uint64_t> completeSet(Board::offsetTupleWords);
+        uint64_t solvedGeneration = 0;
+        while (true) {
+            uint64_t generation;
+            {
+                std::unique_lock<std::mutex> lock(solver->m_mutex);
+                solver->m_condition.wait(lock, [&] () { return solver->m_requestGeneration != solvedGeneration; });
+                memcpy(completeSet.data(), solver->m_completeSet, sizeof(solver->m_completeSet));
+                generation = solver->m_requestGeneration;
+            }
+            auto solveBegin = std::chrono::steady_clock::now();
+            HintTable<Board> *table = &solver->m_table[solver->m_back];
+            solveOffsetHint(completeSet.data(), table);
+            table->m_generation = generation;
+            table->m_solveTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - solveBegin).count();
+            solver->m_back = solver->m_middle.exchange(solver->m_back | FRESH_FRAME_BIT, std::memory_order_acq_rel) & FRAME_SLOT_MASK;
+            solvedGeneration = generation;
+            postGameEvent(queue, HINT_EVENT);
+        }
+    }).detach();
+}
+
+template <typename Board>
+void startOffsetHintSolver (HintSolver<Board> *, GameEventQueue<Board> *, std::false_type) {
+}
+
+// Hint of current rail offsets from latest solved table, microseconds at any moment, HINT_UNREACHABLE distance
+// until the table of current checkpoints is solved
+template <typename Board>
+void queryOffsetHint (HintSolver<Board> *solver, const GameStatus<Board> *game, OffsetHint *hint, std::true_type) {
+    if (solver->m_middle.load(std::memory_order_relaxed) & FRESH_FRAME_BIT) {
+        solver->m_front = solver->m_middle.exchange(solver->m_front, std::memory_order_acq_rel) & FRAME_SLOT_MASK;
+    }
+    const HintTable<Board> *table = &solver->m_table[solver->m_front];
+    if (solver->m_generation == 0 || table->m_generation != solver->m_generation) {
+        *hint = OffsetHint{HINT_UNREACHABLE, -1, 0};
+        return;
+    }
+    findOffsetHint(table, game->m_railStatusList, hint);
+}
+
+template <typename Board>
+void queryOffsetHint (HintSolver<Board> *, const GameStatus<Board> *, OffsetHint *hint, std::false_type) {
+    *hint = OffsetHint{HINT_UNREACHABLE, -1, 0};
+}
+#endif
+
+template <typename Board>
+void captureGameFrame (GameStatus<Board> *game, const TimerScheduler *scheduler, GameFrame<Board> *frame) {
+    // Frames show the track history and progress bar a table lookup skips
+    refreshGameProgress(game);
+    memcpy(frame->m_railStatusList, game->m_railStatusList, sizeof(frame->m_railStatusList));
+    memcpy(frame->m_trackStatusList, game->m_trackStatusList, sizeof(frame->m_trackStatusList));
+    frame->m_startTrack = game->m_startTrack;
+    frame->m_endTrack = game->m_endTrack;
+    memcpy(frame->m_adviceAnswerTrackPath, game->m_adviceAnswerTrackPath, sizeof(frame->m_adviceAnswerTrackPath));
+    frame->m_achievedCheckpoint = game->m_achievedCheckpoint;
+    frame->m_isComplete = game->m_isComplete;
+    frame->m_progressBar = game->m_progressBar;
+    frame->m_hasInputLatency = false;
+#ifdef OFFSET_HINT
+    frame->m_hint = OffsetHint{HINT_UNREACHABLE, -1, 0};
+#endif
+
+    frame->m_debug = game->m_debug;
+    frame->m_currentEndTrack = game->m_currentEndTrack;
+    memcpy(frame->m_currentTrackHistory, game->m_currentTrackHistory, sizeof(frame->m_currentTrackHistory));
+    frame->m_retracedPosition = game->m_retracedPosition;
+    frame->m_averageRetracedPosition = static_cast<double>(game->m_retracedPositionTotal) / std::max<size_t>(game->m_traceUpdateAmount, 1);
+#ifdef OFFSET_LOOKUP_TABLE
+    frame->m_lookupTableSize = OffsetSpaceTable<Board>::lookupTableSize;
+    frame->m_lookupSolutionAmount = game->m_lookupSolutionAmount;
+    frame->m_lookupBuildTime = game->m_lookupBuildTime;
+#endif
+    memcpy(frame->m_firedAmount, scheduler->m_firedAmount, sizeof(frame->m_firedAmount));
+}
+
+template <typename Board>
+GraphProperty drawInterleavedTrackAt(const GameFrame<Board> *game, int trackId, int trackPos) {
+    // With color ver.
+    #ifdef TOGGLE_SOLUTION
+    if (game->m_adviceAnswerTrackPath[trackPos] == trackId) {
+        if (isMaskBitSet(game->m_trackStatusList[trackId].m_checkpoint, trackPos)) {
+            return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::YELLOW);
+        } else {
+            return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::BLUE);
+        }
+    } else
+    #endif
+    #ifdef CHECKPOINT_TRIGGER_EVENT
+    if (isMaskBitSet(game->m_trackStatusList[trackId].m_triggerCheckpoint, trackPos)) {
+        return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::RED);
+    } else
+    #endif
+    if (isMaskBitSet(game->m_trackStatusList[trackId].m_checkpoint, trackPos)) {
+        return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::GREEN);
+    } else {
+        return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::WHITE);
+    }
+    // Without color ver.
+    // return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::WHITE);
+}
+
+template <typename Board>
+GraphProperty drawInterleavedRailAt(const GameFrame<Board> *game, int railId, int trackPos) {
+    // If trackPos is not on interleaved possible bar area, then it must print space
+    if (((railId&1) ^ (trackPos&1)) == 0) {
+        return GraphProperty(GraphProperty::GraphIcon::SPACE, GraphProperty::GraphColor::WHITE);
+    }
+    int barPhysicalPos = (trackPos - 2 * game->m_railStatusList[railId].m_offset);
+    if (barPhysicalPos >= 0) {
+        // prevent barPhysicalPos=-1 from divide it with 2 and get zero
+        int barLogicalPos = barPhysicalPos / 2;
+        if (barLogicalPos < Board::barAmount && isMaskBitSet(game->m_railStatusList[railId].m_activeBar, barLogicalPos)) {
+            return GraphProperty(GraphProperty::GraphIcon::DASH, GraphProperty::GraphColor::WHITE);
+        } else {
+            return GraphProperty(GraphProperty::GraphIcon::SPACE, GraphProperty::GraphColor::WHITE);
+        }
+    } else {
+        return GraphProperty(GraphProperty::GraphIcon::SPACE, GraphProperty::GraphColor::WHITE);
+    }
+}
+
+// Screen
+void clearScreenBuffer (ScreenBuffer *screen) {
+    for (int i = 0; i < SCREEN_ROW_AMOUNT; ++i) {
+        for (int j = 0; j < SCREEN_COLUMN_AMOUNT; ++j) {
+            screen->m_cell[i][j] = {' ', GraphProperty::GraphColor::DEFAULT};
+        }
+    }
+    screen->m_cursorRow = 0;
+    screen->m_cursorColumn = 0;
+    screen->m_usedRow = 0;
+}
+
+void putScreenCell (ScreenBuffer *screen, int row, int column, char glyph, GraphProperty::GraphColor color) {
+    if (row >= SCREEN_ROW_AMOUNT || column >= SCREEN_COLUMN_AMOUNT) {
+        return;
+    }
+    // Color of space is invisible, unify it so color runs are longer
+    screen->m_cell[row][column] = {glyph, glyph == ' ' ? GraphProperty::GraphColor::DEFAULT : color};
+    screen->m_usedRow = std::max(screen->m_usedRow, row + 1);
+}
+
+// printf() into screen buffer at text cursor
+void screenPrintf (ScreenBuffer *screen, const char *format, ...) {
+    char text[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    for (const char *ch = text; *ch; ++ch) {
+        if (*ch == '\n') {
+            screen->m_cursorRow++;
+            screen->m_cursorColumn = 0;
+            // Rows past the buffer are clipped, as wide boards are taller than it
+            screen->m_usedRow = std::max(screen->m_usedRow, std::min(screen->m_cursorRow, SCREEN_ROW_AMOUNT));
+        } else {
+            putScreenCell(screen, screen->m_cursorRow, screen->m_cursorColumn++, *ch, GraphProperty::GraphColor::DEFAULT);
+        }
+    }
+}
+
+// Write changed cells with one write, return bytes written
+size_t flushScreenBuffer (ScreenBuffer *screen, FILE *sink) {
+    std::string &output = screen->m_output;
+    output.clear();
+    if (!screen->m_isShown) {
+        output += "\033[2J";
+        for (int i = 0; i < SCREEN_ROW_AMOUNT; ++i) {
+            for (int j = 0; j < SCREEN_COLUMN_AMOUNT; ++j) {
+                screen->m_shownCell[i][j] = {' ', GraphProperty::GraphColor::DEFAULT};
+            }
+        }
+        screen->m_isShown = true;
+    }
+    // Color is only emitted when it differs from the last emitted one
+    bool hasColor = false;
+    GraphProperty::GraphColor currentColor = GraphProperty::GraphColor::DEFAULT;
+    int cursorRow = -1;
+    int cursorColumn = -1;
+    int lastRow = std::max(screen->m_usedRow, screen->m_shownUsedRow);
+    for (int i = 0; i < lastRow; ++i) {
+        for (int j = 0; j < SCREEN_COLUMN_AMOUNT; ++j) {
+            const ScreenCell &cell = screen->m_cell[i][j];
+            if (!(cell != screen->m_shownCell[i][j])) {
+                continue;
+            }
+            // Short gap of unchanged spaces is cheaper to rewrite than addressing cursor
+            bool isSpaceGap = (i == cursorRow && j > cursorColumn && j - cursorColumn <= 4);
+            for (int k = cursorColumn; isSpaceGap && k < j; ++k) {
+                isSpaceGap = screen->m_cell[i][k].m_glyph == ' ';
+            }
+            if (isSpaceGap) {
+                output.append(j - cursorColumn, ' ');
+            } else if (i != cursorRow || j != cursorColumn) {
+                char move[32];
+                snprintf(move, sizeof(move), "\033[%d;%dH", i + 1, j + 1);
+                output += move;
+            }
+            if (!hasColor || cell.m_color != currentColor) {
+                output += GraphProperty::colorCode(cell.m_color);
+                currentColor = cell.m_color;
+                hasColor = true;
+            }
+            output += cell.m_glyph;
+            cursorRow = i;
+            cursorColumn = j + 1;
+            screen->m_shownCell[i][j] = cell;
+        }
+    }
+    if (!output.empty()) {
+        // Leave terminal at default color with cursor below the frame
+        char move[32];
+        snprintf(move, sizeof(move), "\033[%d;1H", screen->m_usedRow + 1);
+        output += DEFAULT_COLOR;
+        output += move;
+        if (sink) {
+            fwrite(output.data(), 1, output.size(), sink);
+            fflush(sink);
+        }
+    }
+    screen->m_shownUsedRow = screen->m_usedRow;
+    screen->m_frameByte = output.size();
+    screen->m_totalByte += output.size();
+    screen->m_frameAmount++;
+    return output.size();
+}
+
+template <typename Board>
+void printGraph (const GameFrame<Board> *game, ScreenBuffer *screen) {
+    // Lines alternate track and rail, only what the screen buffer can show is drawn as wide boards are clipped
+#ifdef TRANSPOSE_GUI
+    constexpr int lineAmount = Board::railAmount + Board::trackAmount < SCREEN_ROW_AMOUNT ? Board::railAmount + Board::trackAmount : SCREEN_ROW_AMOUNT;
+    constexpr int posAmount = Board::interleaveTrackPosAmount < SCREEN_COLUMN_AMOUNT ? Board::interleaveTrackPosAmount : SCREEN_COLUMN_AMOUNT;
+#else
+    constexpr int lineAmount = Board::railAmount + Board::trackAmount < SCREEN_COLUMN_AMOUNT ? Board::railAmount + Board::trackAmount : SCREEN_COLUMN_AMOUNT;
+    constexpr int posAmount = Board::interleaveTrackPosAmount < SCREEN_ROW_AMOUNT ? Board::interleaveTrackPosAmount : SCREEN_ROW_AMOUNT;
+#endif
+    GraphProperty graph[lineAmount][posAmount];
+    for (int j = 0; j < posAmount; ++j) {
+        for (int i = 0; i < lineAmount; ++i) {
+            graph[i][j] = (i % 2 == 0) ? drawInterleavedTrackAt(game, i / 2, j) : drawInterleavedRailAt(game, i / 2, j);
+        }
+    }
+
+    int originRow = screen->m_cursorRow;
+#ifdef TRANSPOSE_GUI
+    for (int i = 0; i < lineAmount; ++i) {
+        for (int j = 0; j < posAmount; ++j) {
+            putScreenCell(screen, originRow + i, j, graph[i][j].glyph(true), graph[i][j].m_color);
+        }
+    }
+    screen->m_cursorRow = originRow + Board::railAmount + Board::trackAmount;
+#else
+    for (int j = 0; j < posAmount; ++j) {
+        for (int i = 0; i < lineAmount; ++i) {
+            putScreenCell(screen, originRow + j, i, graph[i][j].glyph(false), graph[i][j].m_color);
+        }
+    }
+    screen->m_cursorRow = originRow + Board::interleaveTrackPosAmount;
+#endif
+    screen->m_cursorColumn = 0;
+    screen->m_usedRow = std::max(screen->m_usedRow, std::min(screen->m_cursorRow, SCREEN_ROW_AMOUNT));
+}
+
+// Difficulty
+// How hard a board is under its current checkpoints: tuples completing it, fewest steps from all-zero offsets to
+// one, turns of the shortest path through the checkpoints and how tuples near an answer branch toward it. Exact when
+// the lookup table covers the offset space, otherwise winning tuples are estimated from uniform draws and steps are
+// counted on advice offsets.
+template <typename Board>
+using DifficultyAnalysisTag = std::integral_constant<bool,
+#ifdef OFFSET_LOOKUP_TABLE
+    Board::isOffsetSpaceSolved
+#else
+    false
+#endif
+    >;
+
+template <typename Board>
+struct DifficultyReport {
+    // Share of offset tuples completing the board, and their amount when it's exact
+    double m_winningShare;
+    uint64_t m_winningTuple;
+
+    // Upper bound from advice offsets unless it's exact
+    uint32_t m_fewestMoveStep;
+
+    bool m_isExact;
+
+    // Track changes of the shortest path from start track through every checkpoint to end track, of advice path
+    // with multiple set checkpoints
+    int m_checkpointPathTurn;
+
+    // Tuples d steps from the nearest complete tuple and their moves one step closer, so the mean branching toward
+    // an answer on d is m_improvingMove[d] / m_nearSolutionTuple[d], exact reports with OFFSET_HINT only
+    uint64_t m_nearSolutionTuple[NEAR_SOLUTION_DISTANCE + 1];
+    uint64_t m_improvingMove[NEAR_SOLUTION_DISTANCE + 1];
+
+};
+
+// Band of fewest move steps generation keeps boards in, the only part of a report cheap enough to check per board
+typedef struct DifficultyBand {
+    uint32_t m_lowestStep;
+
+    uint32_t m_highestStep;
+
+} DifficultyBand;
+
+// Per worker storage, sampled tuples are evaluated in one batch against the board, which keeps its offsets and trace
+template <typename Board, bool IsExact = DifficultyAnalysisTag<Board>::value>
+struct DifficultyScratch {
+    GameStatus<Board> m_board;
+
+    // Unused where the report is exact
+    OffsetTupleBatch<Board> *m_batch;
+
+#ifdef OFFSET_HINT
+    HintTable<Board> m_hintTable;
+
+    uint64_t m_completeSet[Board::offsetTupleWords];
+#endif
+
+};
+
+template <typename Board>
+struct DifficultyScratch<Board, false> {
+    GameStatus<Board> m_board;
+
+    OffsetTupleBatch<Board> *m_batch;
+
+};
+
+template <typename Board>
+DifficultyScratch<Board> *createDifficultyScratch () {
+    DifficultyScratch<Board> *scratch = new DifficultyScratch<Board>;
+    scratch->m_batch = DifficultyAnalysisTag<Board>::value ? nullptr : createOffsetTupleBatch<Board>(DIFFICULTY_SAMPLE_AMOUNT);
+    return scratch;
+}
+
+template <typename Board>
+void destroyDifficultyScratch (DifficultyScratch<Board> *scratch) {
+    if (scratch->m_batch) {
+        destroyOffsetTupleBatch(scratch->m_batch);
+    }
+    delete scratch;
+}
+
+// Fewest offset level steps from all-zero offsets to a complete tuple. A step moves one rail by one level, so it's
+// the smallest offset sum of a complete tuple, boards whose offset space isn't solved count their advice offsets.
+template <typename Board>
+uint32_t adviceMoveStep (const GameStatus<Board> *game) {
+    uint32_t step = 0;
+    for (int i = 0; i < Board::railAmount; ++i) {
+        step += static_cast<uint32_t>(game->m_railStatusList[i].m_adviceCompleteOffset);
+    }
+    return step;
+}
+
+#ifdef OFFSET_LOOKUP_TABLE
+template <typename Board>
+uint32_t fewestMoveStep (const GameStatus<Board> *game, std::true_type) {
+    uint32_t fewestStep = UINT32_MAX;
+    size_t offsetList[Board::railAmount];
+    for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+        if (!LOOKUP_IS_COMPLETE(game->m_offsetSpace.m_offsetLookupTable[tuple])) {
+            continue;
+        }
+        decodeOffsetTuple<Board>(tuple, offsetList);
+        uint32_t step = 0;
+        for (int i = 0; i < Board::railAmount; ++i) {
+            step += static_cast<uint32_t>(offsetList[i]);
+        }
+        fewestStep = std::min(fewestStep, step);
+    }
+    return fewestStep == UINT32_MAX ? adviceMoveStep(game) : fewestStep;
+}
+#endif
+
+template <typename Board>
+uint32_t fewestMoveStep (const GameStatus<Board> *game, std::false_type) {
+    return adviceMoveStep(game);
+}
+
+// Advice offset steps only bound fewest move steps from above and mostly measure how the advice offsets were
+// drawn, so a band is refused where the steps aren't exact
+template <typename Board>
+bool isDifficultyBandSupported (const DifficultyBand *band) {
+    if (band && !DifficultyAnalysisTag<Board>::value) {
+        fprintf(stderr, "--band needs exact fewest move steps, %d rails boards of this run only have advice offset steps\n", Board::railAmount);
+        return false;
+    }
+    return true;
+}
+
+template <typename Board>
+bool isInDifficultyBand (const GameStatus<Board> *game, const DifficultyBand *band) {
+    uint32_t step = fewestMoveStep(game, DifficultyAnalysisTag<Board>());
+    return step >= band->m_lowestStep && step <= band->m_highestStep;
+}
+
+// Regenerate a board until it's in band, at most DIFFICULTY_BAND_DRAW_LIMIT times, return the boards dropped
+template <typename Board>
+size_t fitDifficultyBand (GameStatus<Board> *game, RandomEngine *engine, const DifficultyBand *band) {
+    size_t dropAmount = 0;
+    while (band && dropAmount < DIFFICULTY_BAND_DRAW_LIMIT && !isInDifficultyBand(game, band)) {
+        regenerateGame(game, engine);
+        updateGameInfo(game);
+        dropAmount++;
+    }
+    return dropAmount;
+}
+
+template <typename Board>
+int checkpointPathTurn (const GameStatus<Board> *game) {
+#ifdef ONE_SET_CHECKPOINT_GENERATION
+    // Distance of position 0 counts every position and track change left
+    int distance = game->m_endTrackDistance[0][game->m_startTrack];
+    return distance == DISTANCE_UNREACHABLE ? -1 : distance - Board::interleaveTrackPosAmount;
+#else
+    int turn = 0;
+    for (int i = 1; i < Board::interleaveTrackPosAmount; ++i) {
+        turn += game->m_adviceAnswerTrackPath[i] != game->m_adviceAnswerTrackPath[i - 1] ? 1 : 0;
+    }
+    return turn;
+#endif
+}
+
+#ifdef OFFSET_LOOKUP_TABLE
+template <typename Board>
+void analyzeDifficulty (const GameStatus<Board> *game, DifficultyScratch<Board> *scratch, DifficultyReport<Board> *report, RandomEngine *, std::true_type) {
+    report->m_winningTuple = game->m_lookupSolutionAmount;
+    report->m_winningShare = static_cast<double>(game->m_lookupSolutionAmount) / Board::offsetTupleAmount;
+    report->m_fewestMoveStep = fewestMoveStep(game, std::true_type());
+    report->m_isExact = true;
+    report->m_checkpointPathTurn = checkpointPathTurn(game);
+    for (int d = 0; d <= NEAR_SOLUTION_DISTANCE; ++d) {
+        report->m_nearSolutionTuple[d] = 0;
+        report->m_improvingMove[d] = 0;
+    }
+  #ifdef OFFSET_HINT
+    for (size_t i = 0; i < Board::offsetTupleWords; ++i) {
+        scratch->m_completeSet[i] = 0;
+    }
+    for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+        if (LOOKUP_IS_COMPLETE(game->m_offsetSpace.m_offsetLookupTable[tuple])) {
+            scratch->m_completeSet[tuple / 64] |= MASK_AT(tuple % 64);
+        }
+    }
+    solveOffsetHint(scratch->m_completeSet, &scratch->m_hintTable);
+    const uint8_t *distance = scratch->m_hintTable.m_distance;
+    for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+        int d = distance[tuple];
+        if (d > NEAR_SOLUTION_DISTANCE) {
+            continue;
+        }
+        report->m_nearSolutionTuple[d]++;
+        size_t stride = 1;
+        for (int i = 0; i < Board::railAmount && d > 0; ++i, stride *= Board::offsetLevelAmount) {
+            size_t level = tuple / stride % Board::offsetLevelAmount;
+            report->m_improvingMove[d] += (level > 0 && distance[tuple - stride] + 1 == d) ? 1 : 0;
+            report->m_improvingMove[d] += (level + 1 < Board::offsetLevelAmount && distance[tuple + stride] + 1 == d) ? 1 : 0;
+        }
+    }
+  #else
+    (void)scratch;
+  #endif
+}
+#endif
+
+template <typename Board>
+void analyzeDifficulty (const GameStatus<Board> *game, DifficultyScratch<Board> *scratch, DifficultyReport<Board> *report, RandomEngine *engine, std::false_type) {
+    OffsetTupleBatch<Board> *batch = scratch->m_batch;
+    batch->m_tupleAmount = DIFFICULTY_SAMPLE_AMOUNT;
+    for (int i = 0; i < Board::railAmount; ++i) {
+        uint16_t *offset = batch->m_offset + i * batch->m_tupleStride;
+        for (size_t k = 0; k < batch->m_tupleAmount; ++k) {
+            offset[k] = static_cast<uint16_t>(randomBelow(engine, Board::offsetLevelAmount));
+        }
+    }
+    evaluateOffsetTupleBatch(game, batch);
+    size_t completeAmount = 0;
+    for (size_t k = 0; k < batch->m_tupleAmount; ++k) {
+        completeAmount += isOffsetTupleComplete(game, batch, k) ? 1 : 0;
+    }
+    report->m_winningShare = static_cast<double>(completeAmount) / DIFFICULTY_SAMPLE_AMOUNT;
+    report->m_winningTuple = 0;
+    report->m_fewestMoveStep = fewestMoveStep(game, std::false_type());
+    report->m_isExact = false;
+    report->m_checkpointPathTurn = checkpointPathTurn(game);
+    for (int d = 0; d <= NEAR_SOLUTION_DISTANCE; ++d) {
+        report->m_nearSolutionTuple[d] = 0;
+        report->m_improvingMove[d] = 0;
+    }
+}
+
+// Headless batch simulation
+#define HISTOGRAM_BUCKET_AMOUNT 20
+
+typedef struct BatchStatistic {
+    size_t m_boardAmount;
+
+    // Bucket i counts values in [2^(i-1), 2^i), bucket 0 counts zero
+    size_t m_railRegenerateHistogram[HISTOGRAM_BUCKET_AMOUNT];
+    size_t m_solutionHistogram[HISTOGRAM_BUCKET_AMOUNT];
+#ifdef OFFSET_LOOKUP_TABLE
+    size_t m_completeTupleHistogram[HISTOGRAM_BUCKET_AMOUNT];
+#endif
+    // Draws findAdmissibleAnswer took when the offset space isn't solved
+    size_t m_adviceDrawHistogram[HISTOGRAM_BUCKET_AMOUNT];
+
+    size_t m_unsolvableRegenerateAmount;
+
+    // Sum of offsetTupleAmount / solution amount, the draws rejection sampling would need, or the draws it took
+    // when the offset space isn't solved
+    double m_expectedAdviceDraw;
+
+    // Freshly generated boards completed by all-zero offsets
+    size_t m_alreadyCompleteAmount;
+
+    // Boards regenerated for being out of difficulty band
+    size_t m_bandRegenerateAmount;
+
+    // Heap allocations of the worker after its first board, which builds the lazy tables
+    size_t m_steadyHeapAllocation;
+
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    size_t m_checkpointRepairAmount;
+
+    // Sum and maximum of m_checkpointGenerateTime
+    double m_checkpointGenerateSecond;
+    double m_slowestCheckpointGenerateSecond;
+
+    // Sum and minimum of m_maximumCheckpoint
+    size_t m_maximumCheckpointTotal;
+    int m_lowestMaximumCheckpoint;
+#endif
+
+    BatchStatistic() : m_boardAmount(0), m_railRegenerateHistogram{}, m_solutionHistogram{},
+#ifdef OFFSET_LOOKUP_TABLE
+        m_completeTupleHistogram{},
+#endif
+        m_adviceDrawHistogram{}, m_unsolvableRegenerateAmount(0), m_expectedAdviceDraw(0), m_alreadyCompleteAmount(0), m_bandRegenerateAmount(0), m_steadyHeapAllocation(0)
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+        , m_checkpointRepairAmount(0), m_checkpointGenerateSecond(0), m_slowestCheckpointGenerateSecond(0),
+        m_maximumCheckpointTotal(0), m_lowestMaximumCheckpoint(INT32_MAX)
+#endif
+        { }
+
+} BatchStatistic;
+
+int histogramBucket (size_t value) {
+    int bucket = 0;
+    while (value && bucket < HISTOGRAM_BUCKET_AMOUNT - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void mergeBatchStatistic (BatchStatistic *total, const BatchStatistic *part) {
+    total->m_boardAmount += part->m_boardAmount;
+    for (int i = 0; i < HISTOGRAM_BUCKET_AMOUNT; ++i) {
+        total->m_railRegenerateHistogram[i] += part->m_railRegenerateHistogram[i];
+        total->m_solutionHistogram[i] += part->m_solutionHistogram[i];
+#ifdef OFFSET_LOOKUP_TABLE
+        total->m_completeTupleHistogram[i] += part->m_completeTupleHistogram[i];
+#endif
+        total->m_adviceDrawHistogram[i] += part->m_adviceDrawHistogram[i];
+    }
+    total->m_unsolvableRegenerateAmount += part->m_unsolvableRegenerateAmount;
+    total->m_expectedAdviceDraw += part->m_expectedAdviceDraw;
+    total->m_alreadyCompleteAmount += part->m_alreadyCompleteAmount;
+    total->m_bandRegenerateAmount += part->m_bandRegenerateAmount;
+    total->m_steadyHeapAllocation += part->m_steadyHeapAllocation;
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    total->m_checkpointRepairAmount += part->m_checkpointRepairAmount;
+    total->m_checkpointGenerateSecond += part->m_checkpointGenerateSecond;
+    total->m_slowestCheckpointGenerateSecond = std::max(total->m_slowestCheckpointGenerateSecond, part->m_slowestCheckpointGenerateSecond);
+    total->m_maximumCheckpointTotal += part->m_maximumCheckpointTotal;
+    total->m_lowestMaximumCheckpoint = std::min(total->m_lowestMaximumCheckpoint, part->m_lowestMaximumCheckpoint);
+#endif
+}
+
+void printHistogram (const char *title, const size_t *histogram, size_t total) {
+    printf("\n%s:\n", title);
+    for (int i = 0; i < HISTOGRAM_BUCKET_AMOUNT; ++i) {
+        if (histogram[i] == 0) {
+            continue;
+        }
+        size_t lower = i == 0 ? 0 : (1ULL << (i - 1));
+        size_t upper = i == 0 ? 0 : (1ULL << i) - 1;
+        printf("  [%8zu, %8zu] %10zu (%6.2lf%%)\n", lower, upper, histogram[i], histogram[i] * 100.0 / std::max<size_t>(total, 1));
+    }
+}
+
+// Generate, solve and evaluate boardAmount boards on threadAmount threads without GUI.
+// Board i always draws from an engine seeded by (seed, i), so statistics only depend on seed. Boards out of band are
+// regenerated from the same engine when a band is given.
+template <typename Board>
+int runBatchSimulation (size_t boardAmount, int threadAmount, uint64_t seed, const DifficultyBand *band) {
+    if (!isDifficultyBandSupported<Board>(band)) {
+        return 1;
+    }
+    std::atomic<size_t> nextBoard(0);
+    std::vector<BatchStatistic> threadStatistic(threadAmount);
+    std::vector<std::thread> workerList;
+    auto batchBegin = std::chrono::steady_clock::now();
+    for (int i = 0; i < threadAmount; ++i) {
+        workerList.push_back(std::thread([&, i] () {
+            BatchStatistic *statistic = &threadStatistic[i];
+            RandomEngine engine;
+            // Every board of the worker is generated in the same storage
+            GameStatus<Board> *game = new GameStatus<Board>;
+            size_t steadyBegin = 0;
+            size_t board;
+            while ((board = nextBoard++) < boardAmount) {
+                if (statistic->m_boardAmount == 1) {
+                    steadyBegin = threadHeapAllocation();
+                }
+                seedRandomEngine(&engine, seed + board * 0x9E3779B97F4A7C15ULL);
+                regenerateGame(game, &engine);
+                updateGameInfo(game);
+                statistic->m_bandRegenerateAmount += fitDifficultyBand(game, &engine, band);
+                statistic->m_boardAmount++;
+                statistic->m_railRegenerateHistogram[histogramBucket(game->m_railRegenerateTime)]++;
+                statistic->m_solutionHistogram[histogramBucket(game->m_solutionAmount)]++;
+#ifdef OFFSET_LOOKUP_TABLE
+                statistic->m_completeTupleHistogram[histogramBucket(game->m_lookupSolutionAmount)]++;
+#endif
+                statistic->m_unsolvableRegenerateAmount += game->m_unsolvableRegenerateTime;
+                if (Board::isOffsetSpaceSolved) {
+                    statistic->m_expectedAdviceDraw += static_cast<double>(Board::offsetTupleAmount) / game->m_solutionAmount;
+                } else {
+                    statistic->m_expectedAdviceDraw += game->m_adviceDrawAmount;
+                    statistic->m_adviceDrawHistogram[histogramBucket(game->m_adviceDrawAmount)]++;
+                }
+                statistic->m_alreadyCompleteAmount += game->m_isComplete ? 1 : 0;
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+                statistic->m_checkpointRepairAmount += game->m_checkpointRepairTime;
+                statistic->m_checkpointGenerateSecond += game->m_checkpointGenerateTime;
+                statistic->m_slowestCheckpointGenerateSecond = std::max(statistic->m_slowestCheckpointGenerateSecond, game->m_checkpointGenerateTime);
+                statistic->m_maximumCheckpointTotal += game->m_maximumCheckpoint;
+                statistic->m_lowestMaximumCheckpoint = std::min(statistic->m_lowestMaximumCheckpoint, game->m_maximumCheckpoint);
+#endif
+            }
+            if (statistic->m_boardAmount > 1) {
+                statistic->m_steadyHeapAllocation = threadHeapAllocation() - steadyBegin;
+            }
+            destroyGame(game);
+        }));
+    }
+    for (size_t i = 0; i < workerList.size(); ++i) {
+        workerList[i].join();
+    }
+    double elapsedSecond = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchBegin).count();
+
+    BatchStatistic total;
+    for (int i = 0; i < threadAmount; ++i) {
+        mergeBatchStatistic(&total, &threadStatistic[i]);
+    }
+    size_t boards = std::max<size_t>(total.m_boardAmount, 1);
+    printf("Boards: %zu on %d threads in %lf(s), %lf boards per second\n", total.m_boardAmount, threadAmount, elapsedSecond, total.m_boardAmount / elapsedSecond);
+    printf("Seed: %llu\n", static_cast<unsigned long long>(seed));
+    const char *adviceSearchName[] = {"solved", "rejection sampled", "planted"};
+    if (Board::offsetTupleAmount == SIZE_MAX) {
+        printf("Board: %d rails, %d bars, %d checkpoints, %d^%d offset tuples (%s)\n", Board::railAmount, Board::barAmount, Board::checkpointAmount, Board::offsetLevelAmount, Board::railAmount, adviceSearchName[AdviceSearchTag<Board>::value]);
+    } else {
+        printf("Board: %d rails, %d bars, %d checkpoints, %zu offset tuples (%s)\n", Board::railAmount, Board::barAmount, Board::checkpointAmount, Board::offsetTupleAmount, adviceSearchName[AdviceSearchTag<Board>::value]);
+    }
+    printf("RAIL_BAR_GENERATE_PROBABILITY %f, MAXIMUM_COHERENCE %f\n", RAIL_BAR_GENERATE_PROBABILITY, MAXIMUM_COHERENCE);
+    printf("Valid rail masks: %zu, rejection sampling would need %lf draws per %s\n", railMaskSampler<Board::segmentBarAmount>()->m_alias.size(), 1 / railMaskSampler<Board::segmentBarAmount>()->m_validProbability, Board::barAmount > Board::segmentBarAmount ? "rail segment" : "rail");
+    printHistogram("generateGhostLegGraph draws per board", total.m_railRegenerateHistogram, total.m_boardAmount);
+    if (Board::isOffsetSpaceSolved) {
+        printHistogram("Offset tuples reaching end track per board", total.m_solutionHistogram, total.m_boardAmount);
+#ifdef OFFSET_LOOKUP_TABLE
+        printHistogram("Offset tuples completing board per board", total.m_completeTupleHistogram, total.m_boardAmount);
+#endif
+    } else {
+        printHistogram(Board::isWideBoard ? "findAdmissibleAnswer single rail moves per board" : "findAdmissibleAnswer draws per board", total.m_adviceDrawHistogram, total.m_boardAmount);
+    }
+    printf("\nBoards regenerated for having no answer: %zu (%lf per board)\n", total.m_unsolvableRegenerateAmount, static_cast<double>(total.m_unsolvableRegenerateAmount) / boards);
+    if (Board::isOffsetSpaceSolved) {
+        printf("Expected findAdmissibleAnswer draws with rejection sampling: %lf per board\n", total.m_expectedAdviceDraw / boards);
+    } else if (Board::isWideBoard) {
+        printf("findAdmissibleAnswer single rail moves: %lf per board\n", total.m_expectedAdviceDraw / boards);
+    } else {
+        printf("findAdmissibleAnswer draws with rejection sampling: %lf per board\n", total.m_expectedAdviceDraw / boards);
+    }
+    printf("Already complete when generated: %zu (%lf%%)\n", total.m_alreadyCompleteAmount, total.m_alreadyCompleteAmount * 100.0 / boards);
+    if (band) {
+        printf("Boards regenerated to fit fewest move steps %u ~ %u: %zu (%lf per board)\n", band->m_lowestStep, band->m_highestStep, total.m_bandRegenerateAmount, static_cast<double>(total.m_bandRegenerateAmount) / boards);
+    }
+#ifdef HEAP_ALLOCATION_COUNTER
+    printf("Heap allocations after the first board of each thread: %zu\n", total.m_steadyHeapAllocation);
+#endif
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    printf("Checkpoint sets without answer, repaired along advice path: %zu (%lf%%)\n", total.m_checkpointRepairAmount, total.m_checkpointRepairAmount * 100.0 / boards);
+    printf("Checkpoint draw, check and repair: %lf(us) per board, slowest %lf(us)\n", total.m_checkpointGenerateSecond * 1e6 / boards, total.m_slowestCheckpointGenerateSecond * 1e6);
+    printf("Most checkpoints an answer passes: %lf per board, lowest %d, %s\n", static_cast<double>(total.m_maximumCheckpointTotal) / boards, total.m_lowestMaximumCheckpoint,
+        Board::isOffsetSpaceSolved ? "exact" : "on advice path");
+#endif
+    return 0;
+}
+
+// Puzzle bank
+// Boards generated, solved and rated offline, then mapped read only so a round starts without any generation.
+// File is the header, records from a cache line boundary on, and record indices sorted by difficulty. Everything
+// is in native byte order and struct layout, the header names the board size and build flags records depend on.
+#define PUZZLE_BANK_MAGIC "GLBK"
+#define PUZZLE_BANK_VERSION 1
+#define PUZZLE_BANK_ALIGNMENT 64
+
+typedef struct PuzzleBankHeader {
+    char m_magic[4];
+
+    uint32_t m_version;
+
+    int32_t m_railAmount;
+    int32_t m_barAmount;
+    int32_t m_checkpointAmount;
+
+    // puzzleBankLayout() of the build that wrote it
+    uint32_t m_layout;
+
+    uint64_t m_recordSize;
+    uint64_t m_recordAmount;
+
+    uint64_t m_seed;
+
+    // Bucket b is sorted indices [m_bucketBegin[b], m_bucketBegin[b + 1]), boards of equal difficulty share a bucket
+    uint64_t m_bucketBegin[PUZZLE_BANK_BUCKET_AMOUNT + 1];
+
+    // Fewest move steps of the easiest and the hardest board of each bucket
+    uint32_t m_bucketLowestStep[PUZZLE_BANK_BUCKET_AMOUNT];
+    uint32_t m_bucketHighestStep[PUZZLE_BANK_BUCKET_AMOUNT];
+
+} PuzzleBankHeader;
+
+constexpr uint32_t puzzleBankLayout () {
+    return 0
+#ifdef ONE_SET_CHECKPOINT_GENERATION
+        | 1
+#endif
+#ifdef OFFSET_LOOKUP_TABLE
+        | 2
+#endif
+#ifdef CHECKPOINT_TRIGGER_EVENT
+        | 4
+#endif
+        ;
+}
+
+// What a record keeps of the offset space, empty when the offset space isn't solved
+template <typename Board, bool IsOffsetSpaceSolved = Board::isOffsetSpaceSolved>
+struct PuzzleBankOffsetSpace {
+#ifdef OFFSET_LOOKUP_TABLE
+    // Tuples completing the board under its first checkpoints, updateGameInfo() reads them in the mapped bank
+    uint64_t m_completeSet[Board::offsetTupleWords];
+#endif
+
+};
+
+template <typename Board>
+struct PuzzleBankOffsetSpace<Board, false> {
+};
+
+// What round start needs of a generated board: rails, checkpoints, advice offsets, difficulty and complete tuples
+template <typename Board>
+struct PuzzleBankRecord {
+    typename Board::BarMask m_activeBar[Board::railAmount];
+
+    TrackStatus<Board> m_trackStatusList[Board::trackAmount];
+
+    PuzzleBankOffsetSpace<Board> m_offsetSpace;
+
+    uint16_t m_adviceOffset[Board::railAmount];
+
+    uint16_t m_startTrack;
+    uint16_t m_endTrack;
+
+    uint32_t m_fewestMoveStep;
+
+    uint64_t m_solutionAmount;
+
+#ifdef OFFSET_LOOKUP_TABLE
+    uint64_t m_lookupSolutionAmount;
+#endif
+
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    int32_t m_maximumCheckpoint;
+#endif
+
+};
+
+typedef struct PuzzleBank {
+    const uint8_t *m_data;
+
+    size_t m_size;
+
+    const PuzzleBankHeader *m_header;
+
+} PuzzleBank;
+
+constexpr size_t puzzleBankRecordBegin () {
+    return (sizeof(PuzzleBankHeader) + PUZZLE_BANK_ALIGNMENT - 1) / PUZZLE_BANK_ALIGNMENT * PUZZLE_BANK_ALIGNMENT;
+}
+
+size_t puzzleBankIndexBegin (const PuzzleBankHeader *header) {
+    return puzzleBankRecordBegin() + header->m_recordAmount * header->m_recordSize;
+}
+
+template <typename Board>
+void storePuzzleBankOffsetSpace (PuzzleBankOffsetSpace<Board> *offsetSpace, const GameStatus<Board> *game, std::true_type) {
+#ifdef OFFSET_LOOKUP_TABLE
+    for (size_t tuple = 0; tuple < Board::offsetTupleAmount; ++tuple) {
+        if (LOOKUP_IS_COMPLETE(game->m_offsetSpace.m_offsetLookupTable[tuple])) {
+            offsetSpace->m_completeSet[tuple / 64] |= MASK_AT(tuple % 64);
+        }
+    }
+#else
+    (void)offsetSpace;
+    (void)game;
+#endif
+}
+
+template <typename Board>
+void storePuzzleBankOffsetSpace (PuzzleBankOffsetSpace<Board> *, const GameStatus<Board> *, std::false_type) {
+}
+
+// Nothing is copied, the board points at the record until its offset space is solved on checkpoint regeneration
+template <typename Board>
+void loadPuzzleBankOffsetSpace (GameStatus<Board> *game, const PuzzleBankOffsetSpace<Board> *offsetSpace, std::true_type) {
+#ifdef OFFSET_LOOKUP_TABLE
+    game->m_bankCompleteSet = offsetSpace->m_completeSet;
+#else
+    (void)game;
+    (void)offsetSpace;
+#endif
+}
+
+template <typename Board>
+void loadPuzzleBankOffsetSpace (GameStatus<Board> *, const PuzzleBankOffsetSpace<Board> *, std::false_type) {
+}
+
+template <typename Board>
+void storePuzzleBankRecord (PuzzleBankRecord<Board> *record, const GameStatus<Board> *game) {
+    // Padding is cleared too, so a bank only depends on its seed
+    memset(static_cast<void *>(record), 0, sizeof(PuzzleBankRecord<Board>));
+    for (int i = 0; i < Board::railAmount; ++i) {
+        record->m_activeBar[i] = game->m_railStatusList[i].m_activeBar;
+        record->m_adviceOffset[i] = static_cast<uint16_t>(game->m_railStatusList[i].m_adviceCompleteOffset);
+    }
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        record->m_trackStatusList[i] = game->m_trackStatusList[i];
+    }
+    storePuzzleBankOffsetSpace(&record->m_offsetSpace, game, OffsetSpaceSolvedTag<Board>());
+    record->m_startTrack = static_cast<uint16_t>(game->m_startTrack);
+    record->m_endTrack = static_cast<uint16_t>(game->m_endTrack);
+    record->m_fewestMoveStep = fewestMoveStep(game, DifficultyAnalysisTag<Board>());
+#ifdef OFFSET_LOOKUP_TABLE
+    record->m_lookupSolutionAmount = game->m_lookupSolutionAmount;
+#endif
+    record->m_solutionAmount = game->m_solutionAmount;
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    record->m_maximumCheckpoint = game->m_maximumCheckpoint;
+#endif
+}
+
+// Board in the storage of a finished one as generation left it, only the advice path and distance field are traced.
+// The record has to stay mapped while the board is played.
+template <typename Board>
+void loadPuzzleBankRecord (GameStatus<Board> *game, const PuzzleBankRecord<Board> *record) {
+    new (game) GameStatus<Board>();
+    for (int i = 0; i < Board::railAmount; ++i) {
+        game->m_railStatusList[i].m_activeBar = record->m_activeBar[i];
+        game->m_railStatusList[i].m_adviceCompleteOffset = record->m_adviceOffset[i];
+    }
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        game->m_trackStatusList[i] = record->m_trackStatusList[i];
+    }
+    game->m_startTrack = record->m_startTrack;
+    game->m_endTrack = record->m_endTrack;
+    loadPuzzleBankOffsetSpace(game, &record->m_offsetSpace, OffsetSpaceSolvedTag<Board>());
+    game->m_solutionAmount = record->m_solutionAmount;
+#ifdef OFFSET_LOOKUP_TABLE
+    game->m_lookupSolutionAmount = record->m_lookupSolutionAmount;
+    game->m_lookupTuple = Board::offsetTupleAmount;
+#endif
+#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
+    game->m_maximumCheckpoint = record->m_maximumCheckpoint;
+#endif
+    updateAdviceAnswerTrackPath(game);
+#ifdef ONE_SET_CHECKPOINT_GENERATION
+    updateDistanceField(game);
+#endif
+}
+
+// fseek() takes a long, 32 bits on Windows, records past 2 GB need the 64 bit variants
+bool seekPuzzleBank (FILE *file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+void closePuzzleBank (PuzzleBank *bank) {
+#ifdef _WIN32
+    UnmapViewOfFile(bank->m_data);
+#elif __unix__
+    munmap(const_cast<uint8_t *>(bank->m_data), bank->m_size);
+#endif
+    delete bank;
+}
+
+// Map the whole bank read only, nullptr if it can't be mapped or wasn't written by this version and build
+PuzzleBank *openPuzzleBank (const char *path) {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = GetFileSizeEx(file, &fileSize) ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (mapping) {
+        size = static_cast<size_t>(fileSize.QuadPart);
+        data = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        // The view keeps the mapping alive
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#elif __unix__
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return nullptr;
+    }
+    struct stat fileStat;
+    if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0) {
+        size = static_cast<size_t>(fileStat.st_size);
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+        data = mapping == MAP_FAILED ? nullptr : static_cast<const uint8_t *>(mapping);
+    }
+    close(file);
+#endif
+    if (!data) {
+        return nullptr;
+    }
+    PuzzleBank *bank = new PuzzleBank();
+    bank->m_data = data;
+    bank->m_size = size;
+    bank->m_header = reinterpret_cast<const PuzzleBankHeader *>(data);
+    const PuzzleBankHeader *header = bank->m_header;
+    if (size < puzzleBankRecordBegin() || memcmp(header->m_magic, PUZZLE_BANK_MAGIC, 4) != 0 ||
+        header->m_version != PUZZLE_BANK_VERSION || header->m_layout != puzzleBankLayout() ||
+        header->m_bucketBegin[PUZZLE_BANK_BUCKET_AMOUNT] != header->m_recordAmount ||
+        size < puzzleBankIndexBegin(header) + header->m_recordAmount * sizeof(uint32_t)) {
+        closePuzzleBank(bank);
+        return nullptr;
+    }
+    return bank;
+}
+
+template <typename Board>
+bool isPuzzleBankOf (const PuzzleBank *bank) {
+    const PuzzleBankHeader *header = bank->m_header;
+    return header->m_railAmount == Board::railAmount && header->m_barAmount == Board::barAmount &&
+        header->m_checkpointAmount == Board::checkpointAmount && header->m_recordSize == sizeof(PuzzleBankRecord<Board>);
+}
+
+template <typename Board>
+const PuzzleBankRecord<Board> *puzzleBankRecord (const PuzzleBank *bank, size_t n) {
+    return reinterpret_cast<const PuzzleBankRecord<Board> *>(bank->m_data + puzzleBankRecordBegin() + n * sizeof(PuzzleBankRecord<Board>));
+}
+
+// Uniform board of a difficulty bucket, any board if bucket is negative, nullptr if the bank has none
+template <typename Board>
+const PuzzleBankRecord<Board> *pickPuzzleBankRecord (const PuzzleBank *bank, int bucket, RandomEngine *engine) {
+    if (!isPuzzleBankOf<Board>(bank) || bucket >= PUZZLE_BANK_BUCKET_AMOUNT) {
+        return nullptr;
+    }
+    const PuzzleBankHeader *header = bank->m_header;
+    size_t begin = bucket < 0 ? 0 : header->m_bucketBegin[bucket];
+    size_t end = bucket < 0 ? header->m_recordAmount : header->m_bucketBegin[bucket + 1];
+    if (begin == end) {
+        return nullptr;
+    }
+    const uint32_t *sortedIndex = reinterpret_cast<const uint32_t *>(bank->m_data + puzzleBankIndexBegin(header));
+    return puzzleBankRecord<Board>(bank, sortedIndex[begin + randomBelow(engine, end - begin)]);
+}
+
+// First board of a round, picked from the bank when it holds one of this size and bucket, otherwise generated
+template <typename Board>
+GameStatus<Board> *generateRoundGame (const PuzzleBank *bank, int bucket, RandomEngine *engine) {
+    const PuzzleBankRecord<Board> *record = bank ? pickPuzzleBankRecord<Board>(bank, bucket, engine) : nullptr;
+    if (!record) {
+        return generateFirstGame<Board>(engine);
+    }
+    GameStatus<Board> *game = new GameStatus<Board>;
+    loadPuzzleBankRecord(game, record);
+    updateGameInfo(game);
+    return game;
+}
+
+// Generate boardAmount boards on threadAmount threads and write them to path. Board i draws from an engine seeded
+// by (seed, i) as batch simulation does and boards complete at all-zero offsets are regenerated, so the bank only
+// depends on seed. Boards out of band are regenerated as well when a band is given. Buckets split boards sorted by
+// fewest move steps into equal parts.
+template <typename Board>
+int runPuzzleBankBuild (const char *path, size_t boardAmount, int threadAmount, uint64_t seed, const DifficultyBand *band) {
+    if (!isDifficultyBandSupported<Board>(band)) {
+        return 1;
+    }
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    boardAmount = std::min<size_t>(boardAmount, UINT32_MAX);
+    std::atomic<size_t> nextBoard(0);
+    std::atomic<size_t> bandRegenerateAmount(0);
+    std::vector<uint32_t> moveStep(boardAmount);
+    std::mutex fileMutex;
+    bool isWriteFailed = false;
+    std::vector<std::thread> workerList;
+    auto buildBegin = std::chrono::steady_clock::now();
+    for (int i = 0; i < threadAmount; ++i) {
+        workerList.push_back(std::thread([&] () {
+            RandomEngine engine;
+            GameStatus<Board> *game = new GameStatus<Board>;
+            PuzzleBankRecord<Board> *record = new PuzzleBankRecord<Board>();
+            size_t board;
+            while ((board = nextBoard++) < boardAmount) {
+                seedRandomEngine(&engine, seed + board * 0x9E3779B97F4A7C15ULL);
+                regenerateGame(game, &engine);
+                updateGameInfo(game);
+                size_t bandDrop = 0;
+                while (game->m_isComplete || (band && bandDrop < DIFFICULTY_BAND_DRAW_LIMIT && !isInDifficultyBand(game, band))) {
+                    bandDrop += game->m_isComplete ? 0 : 1;
+                    regenerateGame(game, &engine);
+                    updateGameInfo(game);
+                }
+                bandRegenerateAmount += bandDrop;
+                storePuzzleBankRecord(record, game);
+                moveStep[board] = record->m_fewestMoveStep;
+                std::lock_guard<std::mutex> lock(fileMutex);
+                if (!seekPuzzleBank(file, puzzleBankRecordBegin() + static_cast<uint64_t>(board) * sizeof(PuzzleBankRecord<Board>)) ||
+                    fwrite(record, sizeof(PuzzleBankRecord<Board>), 1, file) != 1) {
+                    isWriteFailed = true;
+                }
+            }
+            delete record;
+            destroyGame(game);
+        }));
+    }
+    for (size_t i = 0; i < workerList.size(); ++i) {
+        workerList[i].join();
+    }
+
+    std::vector<uint32_t> sortedIndex(boardAmount);
+    for (size_t i = 0; i < boardAmount; ++i) {
+        sortedIndex[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(sortedIndex.begin(), sortedIndex.end(), [&] (uint32_t a, uint32_t b) {
+        return moveStep[a] < moveStep[b];
+    });
+    PuzzleBankHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, PUZZLE_BANK_MAGIC, 4);
+    header.m_version = PUZZLE_BANK_VERSION;
+    header.m_railAmount = Board::railAmount;
+    header.m_barAmount = Board::barAmount;
+    header.m_checkpointAmount = Board::checkpointAmount;
+    header.m_layout = puzzleBankLayout();
+    header.m_recordSize = sizeof(PuzzleBankRecord<Board>);
+    header.m_recordAmount = boardAmount;
+    header.m_seed = seed;
+    for (int b = 1; b <= PUZZLE_BANK_BUCKET_AMOUNT; ++b) {
+        size_t begin = std::max<size_t>(boardAmount * b / PUZZLE_BANK_BUCKET_AMOUNT, header.m_bucketBegin[b - 1]);
+        while (begin > 0 && begin < boardAmount && moveStep[sortedIndex[begin]] == moveStep[sortedIndex[begin - 1]]) {
+            begin++;
+        }
+        header.m_bucketBegin[b] = begin;
+    }
+    for (int b = 0; b < PUZZLE_BANK_BUCKET_AMOUNT; ++b) {
+        if (header.m_bucketBegin[b] < header.m_bucketBegin[b + 1]) {
+            header.m_bucketLowestStep[b] = moveStep[sortedIndex[header.m_bucketBegin[b]]];
+            header.m_bucketHighestStep[b] = moveStep[sortedIndex[header.m_bucketBegin[b + 1] - 1]];
+        }
+    }
+    char padding[puzzleBankRecordBegin() - sizeof(PuzzleBankHeader) + 1] = {};
+    if (!seekPuzzleBank(file, puzzleBankIndexBegin(&header)) ||
+        fwrite(sortedIndex.data(), sizeof(uint32_t), boardAmount, file) != boardAmount ||
+        !seekPuzzleBank(file, 0) || fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(padding, 1, puzzleBankRecordBegin() - sizeof(PuzzleBankHeader), file) != puzzleBankRecordBegin() - sizeof(PuzzleBankHeader)) {
+        isWriteFailed = true;
+    }
+    isWriteFailed = fclose(file) != 0 || isWriteFailed;
+    if (isWriteFailed) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    double elapsedSecond = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildBegin).count();
+
+    printf("Bank: %zu boards of %d rails on %d threads in %lf(s), %zu bytes per board, %zu bytes\n", boardAmount, Board::railAmount, threadAmount,
+        elapsedSecond, sizeof(PuzzleBankRecord<Board>), puzzleBankIndexBegin(&header) + boardAmount * sizeof(uint32_t));
+    printf("Seed: %llu\n", static_cast<unsigned long long>(seed));
+    if (band) {
+        printf("Boards regenerated to fit fewest move steps %u ~ %u: %zu\n", band->m_lowestStep, band->m_highestStep, bandRegenerateAmount.load());
+    }
+    for (int b = 0; b < PUZZLE_BANK_BUCKET_AMOUNT; ++b) {
+        printf("Bucket %d: %zu boards, fewest move steps %u ~ %u\n", b, static_cast<size_t>(header.m_bucketBegin[b + 1] - header.m_bucketBegin[b]),
+            header.m_bucketLowestStep[b], header.m_bucketHighestStep[b]);
+    }
+    return 0;
+}
+
+// Work-stealing pool
+// Fixed workers, each one owns a deque of tasks, runs its newest task first and steals the oldest task of
+// another worker when its own deque runs dry
+typedef struct WorkerQueue {
+    std::mutex m_mutex;
+
+    std::deque<std::function<void()> > m_task;
+
+    // Worker only, read after the pool is idle
+    uint64_t m_busyNanosecond;
+    size_t m_taskAmount;
+    size_t m_stealAmount;
+
+    WorkerQueue() : m_busyNanosecond(0), m_taskAmount(0), m_stealAmount(0) { }
+
+} WorkerQueue;
+
+typedef struct WorkStealingPool {
+    WorkerQueue *m_queue;
+
+    int m_workerAmount;
+
+    std::vector<std::thread> m_worker;
+
+    // Guards sleeping workers and idle waiters
+    std::mutex m_mutex;
+
+    std::condition_variable m_condition;
+
+    std::condition_variable m_idleCondition;
+
+    // Tasks in deques, briefly negative when a task is taken before its submitter counts it
+    std::atomic<int64_t> m_queuedTask;
+
+    // Tasks submitted and not finished yet
+    std::atomic<int64_t> m_unfinishedTask;
+
+    bool m_isStopping;
+
+} WorkStealingPool;
+
+bool takePoolTask (WorkStealingPool *pool, int worker, std::function<void()> *task, bool *isStolen) {
+    for (int i = 0; i < pool->m_workerAmount; ++i) {
+        WorkerQueue *queue = &pool->m_queue[(worker + i) % pool->m_workerAmount];
+        std::lock_guard<std::mutex> lock(queue->m_mutex);
+        if (queue->m_task.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            *task = std::move(queue->m_task.back());
+            queue->m_task.pop_back();
+        } else {
+            *task = std::move(queue->m_task.front());
+            queue->m_task.pop_front();
+        }
+        *isStolen = i > 0;
+        return true;
+    }
+    return false;
+}
+
+// Index of the pool worker running the calling thread, -1 off the pool
+thread_local int poolWorker = -1;
+
+int currentPoolWorker () {
+    return poolWorker;
+}
+
+void runPoolWorker (WorkStealingPool *pool, int worker) {
+    poolWorker = worker;
+    WorkerQueue *ownQueue = &pool->m_queue[worker];
+    std::function<void()> task;
+    bool isStolen;
+    while (true) {
+        if (!takePoolTask(pool, worker, &task, &isStolen)) {
+            std::unique_lock<std::mutex> lock(pool->m_mutex);
+            pool->m_condition.wait(lock, [&] () { return pool->m_queuedTask > 0 || pool->m_isStopping; });
+            if (pool->m_isStopping && pool->m_queuedTask <= 0) {
+                return;
+            }
+            continue;
+        }
+        pool->m_queuedTask--;
+        auto taskBegin = std::chrono::steady_clock::now();
+        task();
+        ownQueue->m_busyNanosecond += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - taskBegin).count();
+        ownQueue->m_taskAmount++;
+        ownQueue->m_stealAmount += isStolen ? 1 : 0;
+        if (--pool->m_unfinishedTask == 0) {
+            std::lock_guard<std::mutex> lock(pool->m_mutex);
+            pool->m_idleCondition.notify_all();
+        }
+    }
+}
+
+WorkStealingPool *createWorkStealingPool (int workerAmount) {
+    WorkStealingPool *pool = new WorkStealingPool();
+    pool->m_workerAmount = std::max(workerAmount, 1);
+    pool->m_queue = new WorkerQueue[pool->m_workerAmount];
+    pool->m_queuedTask = 0;
+    pool->m_unfinishedTask = 0;
+    pool->m_isStopping = false;
+    for (int i = 0; i < pool->m_workerAmount; ++i) {
+        pool->m_worker.push_back(std::thread(runPoolWorker, pool, i));
+    }
+    return pool;
+}
+
+// Queue a task on worker's deque, any worker may end up running it
+void submitPoolTask (WorkStealingPool *pool, int worker, std::function<void()> task) {
+    pool->m_unfinishedTask++;
+    WorkerQueue *queue = &pool->m_queue[worker % pool->m_workerAmount];
+    {
+        std::lock_guard<std::mutex> lock(queue->m_mutex);
+        queue->m_task.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool->m_mutex);
+        pool->m_queuedTask++;
+    }
+    pool->m_condition.notify_one();
+}
+
+void waitPoolIdle (WorkStealingPool *pool) {
+    std::unique_lock<std::mutex> lock(pool->m_mutex);
+    pool->m_idleCondition.wait(lock, [&] () { return pool->m_unfinishedTask == 0; });
+}
+
+void destroyWorkStealingPool (WorkStealingPool *pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->m_mutex);
+        pool->m_isStopping = true;
+    }
+    pool->m_condition.notify_all();
+    for (size_t i = 0; i < pool->m_worker.size(); ++i) {
+        pool->m_worker[i].join();
+    }
+    delete [] pool->m_queue;
+    delete pool;
+}
+
+// Generate and analyze boardAmount boards on a work-stealing pool of threadAmount workers, one task per board.
+// Board i draws from an engine seeded by (seed, i) as batch simulation does, so the report only depends on seed.
+// Boards complete at all-zero offsets are regenerated as a round or the puzzle bank does, they would rate 0 steps.
+template <typename Board>
+int runDifficultyAnalysis (size_t boardAmount, int threadAmount, uint64_t seed, const DifficultyBand *band) {
+    if (!isDifficultyBandSupported<Board>(band)) {
+        return 1;
+    }
+    WorkStealingPool *pool = createWorkStealingPool(threadAmount);
+    std::vector<DifficultyScratch<Board> *> scratchList(pool->m_workerAmount);
+    for (size_t i = 0; i < scratchList.size(); ++i) {
+        scratchList[i] = createDifficultyScratch<Board>();
+    }
+    std::vector<DifficultyReport<Board> > reportList(boardAmount);
+    std::atomic<size_t> dropAmount(0);
+    auto analysisBegin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < boardAmount; ++i) {
+        submitPoolTask(pool, static_cast<int>(i % pool->m_workerAmount), [&, i] () {
+            DifficultyScratch<Board> *scratch = scratchList[currentPoolWorker()];
+            RandomEngine engine;
+            seedRandomEngine(&engine, seed + i * 0x9E3779B97F4A7C15ULL);
+            GameStatus<Board> *game = &scratch->m_board;
+            regenerateGame(game, &engine);
+            updateGameInfo(game);
+            size_t bandDrop = 0;
+            while (game->m_isComplete || (band && bandDrop < DIFFICULTY_BAND_DRAW_LIMIT && !isInDifficultyBand(game, band))) {
+                bandDrop += game->m_isComplete ? 0 : 1;
+                regenerateGame(game, &engine);
+                updateGameInfo(game);
+            }
+            dropAmount += bandDrop;
+            analyzeDifficulty(&scratch->m_board, scratch, &reportList[i], &engine, DifficultyAnalysisTag<Board>());
+        });
+    }
+    waitPoolIdle(pool);
+    double elapsedSecond = std::chrono::duration<double>(std::chrono::steady_clock::now() - analysisBegin).count();
+    size_t stealAmount = 0;
+    for (int i = 0; i < pool->m_workerAmount; ++i) {
+        stealAmount += pool->m_queue[i].m_stealAmount;
+    }
+    int workerAmount = pool->m_workerAmount;
+    destroyWorkStealingPool(pool);
+    for (size_t i = 0; i < scratchList.size(); ++i) {
+        destroyDifficultyScratch(scratchList[i]);
+    }
+
+    size_t boards = std::max<size_t>(boardAmount, 1);
+    size_t stepHistogram[HISTOGRAM_BUCKET_AMOUNT] = {};
+    size_t turnHistogram[HISTOGRAM_BUCKET_AMOUNT] = {};
+    size_t winningHistogram[HISTOGRAM_BUCKET_AMOUNT] = {};
+    std::vector<uint32_t> stepList(boardAmount);
+    double winningShareTotal = 0;
+    double turnTotal = 0;
+    uint64_t nearSolutionTotal[NEAR_SOLUTION_DISTANCE + 1] = {};
+    uint64_t improvingMoveTotal[NEAR_SOLUTION_DISTANCE + 1] = {};
+    for (size_t i = 0; i < boardAmount; ++i) {
+        const DifficultyReport<Board> *report = &reportList[i];
+        stepHistogram[histogramBucket(report->m_fewestMoveStep)]++;
+        turnHistogram[histogramBucket(std::max(report->m_checkpointPathTurn, 0))]++;
+        winningHistogram[histogramBucket(report->m_winningTuple)]++;
+        stepList[i] = report->m_fewestMoveStep;
+        winningShareTotal += report->m_winningShare;
+        turnTotal += report->m_checkpointPathTurn;
+        for (int d = 0; d <= NEAR_SOLUTION_DISTANCE; ++d) {
+            nearSolutionTotal[d] += report->m_nearSolutionTuple[d];
+            improvingMoveTotal[d] += report->m_improvingMove[d];
+        }
+    }
+    std::sort(stepList.begin(), stepList.end());
+    bool isExact = DifficultyAnalysisTag<Board>::value;
+
+    printf("Boards: %zu analyzed on %d workers in %lf(s), %lf boards per second, %zu tasks stolen\n", boardAmount, workerAmount, elapsedSecond, boardAmount / elapsedSecond, stealAmount);
+    printf("Seed: %llu\n", static_cast<unsigned long long>(seed));
+    if (band) {
+        printf("Boards regenerated to fit fewest move steps %u ~ %u: %zu (%lf per board)\n", band->m_lowestStep, band->m_highestStep, dropAmount.load(), static_cast<double>(dropAmount) / boards);
+    }
+    printf("Board: %d rails, %d checkpoints, %s\n", Board::railAmount, Board::checkpointAmount, isExact ? "exact over the offset space" : "winning share sampled, steps of advice offsets");
+    printHistogram(isExact ? "Fewest move steps from all-zero offsets per board" : "Advice offset steps from all-zero offsets per board", stepHistogram, boardAmount);
+    printHistogram("Checkpoint path turns per board", turnHistogram, boardAmount);
+    if (isExact) {
+        printHistogram("Winning offset tuples per board", winningHistogram, boardAmount);
+    }
+    printf("\nWinning share of offset tuples: %lf%% per board%s\n", winningShareTotal * 100.0 / boards, isExact ? "" : ", sampled");
+    printf("Checkpoint path turns: %lf per board\n", turnTotal / boards);
+    // Equal shares of boards, the bands --band can target
+    printf("%s by quartile:", isExact ? "Fewest move steps" : "Advice offset steps");
+    for (int q = 0; q < 4 && boardAmount > 0; ++q) {
+        printf(" %u ~ %u", stepList[boardAmount * q / 4], stepList[(boardAmount * (q + 1) - 1) / 4]);
+    }
+    printf("\n");
+#ifdef OFFSET_HINT
+    if (isExact) {
+        printf("\nNear solutions, tuples per board and moves toward an answer per tuple:\n");
+        for (int d = 1; d <= NEAR_SOLUTION_DISTANCE; ++d) {
+            printf("  %d steps away %14.1lf %8.3lf\n", d, static_cast<double>(nearSolutionTotal[d]) / boards,
+                static_cast<double>(improvingMoveTotal[d]) / std::max<uint64_t>(nearSolutionTotal[d], 1));
+        }
+    }
+#endif
+    return 0;
+}
+
+// Multi-session engine
+// Boards of a whole floor of toys in one process. Sessions are stored as structure of arrays, field of session s
+// on rail or track i is at i * m_sessionStride + s, so a worker walking a block of sessions reads each field
+// contiguously. Sessions are dealt boards from a small pool instead of solving a board each.
+template <typename Board>
+struct SessionBoard {
+    typename Board::BarMask m_activeBar[Board::railAmount];
+
+    typename Board::PositionMask m_checkpoint[Board::trackAmount];
+
+    uint16_t m_startTrack;
+
+    uint16_t m_endTrack;
+
+};
+
+template <typename Board>
+struct SessionStore {
+    size_t m_sessionAmount;
+
+    // Whole blocks
+    size_t m_sessionStride;
+
+    typename Board::BarMask *m_activeBar;
+
+    uint16_t *m_offset;
+
+    typename Board::PositionMask *m_checkpoint;
+
+    uint16_t *m_startTrack;
+
+    uint16_t *m_endTrack;
+
+    // Pool board each session plays
+    uint32_t *m_boardIndex;
+
+    // Result of last evaluation
+    uint16_t *m_currentEndTrack;
+    uint16_t *m_achievedCheckpoint;
+    uint8_t *m_isComplete;
+
+    // Session has an offset changed since last evaluation, owned by the task processing its block
+    uint8_t *m_isChanged;
+
+    static constexpr size_t sessionByte = Board::railAmount * (sizeof(typename Board::BarMask) + sizeof(uint16_t)) +
+        Board::trackAmount * sizeof(typename Board::PositionMask) + 4 * sizeof(uint16_t) + sizeof(uint32_t) + 2 * sizeof(uint8_t);
+
+};
+
+template <typename Board>
+SessionStore<Board> *createSessionStore (size_t sessionAmount) {
+    SessionStore<Board> *store = new SessionStore<Board>();
+    store->m_sessionAmount = sessionAmount;
+    store->m_sessionStride = (sessionAmount + SESSION_BLOCK_SIZE - 1) / SESSION_BLOCK_SIZE * SESSION_BLOCK_SIZE;
+    store->m_activeBar = new typename Board::BarMask[Board::railAmount * store->m_sessionStride]();
+    store->m_offset = new uint16_t[Board::railAmount * store->m_sessionStride]();
+    store->m_checkpoint = new typename Board::PositionMask[Board::trackAmount * store->m_sessionStride]();
+    store->m_startTrack = new uint16_t[store->m_sessionStride]();
+    store->m_endTrack = new uint16_t[store->m_sessionStride]();
+    store->m_boardIndex = new uint32_t[store->m_sessionStride]();
+    store->m_currentEndTrack = new uint16_t[store->m_sessionStride]();
+    store->m_achievedCheckpoint = new uint16_t[store->m_sessionStride]();
+    store->m_isComplete = new uint8_t[store->m_sessionStride]();
+    store->m_isChanged = new uint8_t[store->m_sessionStride]();
+    return store;
+}
+
+template <typename Board>
+void destroySessionStore (SessionStore<Board> *store) {
+    delete [] store->m_activeBar;
+    delete [] store->m_offset;
+    delete [] store->m_checkpoint;
+    delete [] store->m_startTrack;
+    delete [] store->m_endTrack;
+    delete [] store->m_boardIndex;
+    delete [] store->m_currentEndTrack;
+    delete [] store->m_achievedCheckpoint;
+    delete [] store->m_isComplete;
+    delete [] store->m_isChanged;
+    delete store;
+}
+
+template <typename Board>
+void dealSessionBoard (SessionStore<Board> *store, size_t session, const SessionBoard<Board> *board, uint32_t boardIndex) {
+    for (int i = 0; i < Board::railAmount; ++i) {
+        store->m_activeBar[i * store->m_sessionStride + session] = board->m_activeBar[i];
+    }
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        store->m_checkpoint[i * store->m_sessionStride + session] = board->m_checkpoint[i];
+    }
+    store->m_startTrack[session] = board->m_startTrack;
+    store->m_endTrack[session] = board->m_endTrack;
+    store->m_boardIndex[session] = boardIndex;
+}
+
+// Follow start track as evaluateOffsetTuple() does, counting checkpoints on every position as updateCurrentTrace() does
+template <typename Board>
+void evaluateSession (SessionStore<Board> *store, size_t session) {
+    const size_t stride = store->m_sessionStride;
+    int track = store->m_startTrack[session];
+    int achievedCheckpoint = 0;
+    for (int i = 0; i < Board::interleaveTrackPosAmount; ++i) {
+        achievedCheckpoint += isMaskBitSet(store->m_checkpoint[track * stride + session], i) ? 1 : 0;
+        int rail = ((track ^ i) & 1) ? track : track - 1;
+        if (rail < 0 || rail >= Board::railAmount) {
+            continue;
+        }
+        int bar = i / 2 - store->m_offset[rail * stride + session];
+        if (bar >= 0 && bar < Board::barAmount && isMaskBitSet(store->m_activeBar[rail * stride + session], bar)) {
+            track += (rail == track) ? 1 : -1;
+        }
+    }
+    store->m_currentEndTrack[session] = static_cast<uint16_t>(track);
+    store->m_achievedCheckpoint[session] = static_cast<uint16_t>(achievedCheckpoint);
+    store->m_isComplete[session] = (track == store->m_endTrack[session]) && (achievedCheckpoint >= Board::checkpointAmount);
+}
+
+// Toy endpoints stream batches of inputs framed as sensor samples, a uint32 input amount then per input uint32
+// session, uint16 rail, uint16 reserved and float physical offset, all little endian
+typedef struct SessionInput {
+    uint32_t m_session;
+
+    int m_rail;
+
+    float m_physicalOffset;
+
+} SessionInput;
+
+// Read up to capacity inputs across batch boundaries, return 0 at end of stream
+size_t readSessionInput (SensorSource *source, SessionInput *input, size_t capacity) {
+    uint8_t record[12];
+    size_t inputAmount = 0;
+    while (inputAmount < capacity) {
+        if (source->m_remainingSample == 0) {
+            // Only wait for the next batch when nothing is read yet
+            uint8_t header[4];
+            if (inputAmount > 0 || fread(header, 1, 4, source->m_file) != 4) {
+                break;
+            }
+            source->m_remainingSample = header[0] | (header[1] << 8) | (header[2] << 16) | (static_cast<uint32_t>(header[3]) << 24);
+            continue;
+        }
+        if (fread(record, 1, 12, source->m_file) != 12) {
+            source->m_remainingSample = 0;
+            break;
+        }
+        uint32_t offsetBit = record[8] | (record[9] << 8) | (record[10] << 16) | (static_cast<uint32_t>(record[11]) << 24);
+        input[inputAmount].m_session = record[0] | (record[1] << 8) | (record[2] << 16) | (static_cast<uint32_t>(record[3]) << 24);
+        input[inputAmount].m_rail = record[4] | (record[5] << 8);
+        memcpy(&input[inputAmount].m_physicalOffset, &offsetBit, sizeof(offsetBit));
+        inputAmount++;
+        source->m_remainingSample--;
+    }
+    return inputAmount;
+}
+
+// Inputs of a block wait here until a task takes them, at most one task of a block is queued or running
+typedef struct SessionBlock {
+    std::mutex m_mutex;
+
+    std::vector<SessionInput> m_pendingInput;
+
+    bool m_isScheduled;
+
+    SessionBlock() : m_isScheduled(false) { }
+
+} SessionBlock;
+
+template <typename Board>
+struct SessionEngine {
+    SessionStore<Board> *m_store;
+
+    std::vector<SessionBoard<Board> > m_boardPool;
+
+    SessionBlock *m_block;
+
+    size_t m_blockAmount;
+
+    WorkStealingPool *m_pool;
+
+    // Completed boards are reported here, nullptr keeps the engine silent
+    FILE *m_output;
+
+    std::mutex m_outputMutex;
+
+    std::atomic<size_t> m_inputAmount;
+    std::atomic<size_t> m_invalidInputAmount;
+    std::atomic<size_t> m_evaluateAmount;
+    std::atomic<size_t> m_completeAmount;
+
+};
+
+// Take every pending input of the block until none is left, apply the offset levels railInputMapping() would and
+// evaluate each changed session once. A complete session is dealt the next pool board, rails stay where they are.
+template <typename Board>
+void processSessionBlock (SessionEngine<Board> *engine, size_t blockIndex) {
+    SessionBlock *block = &engine->m_block[blockIndex];
+    SessionStore<Board> *store = engine->m_store;
+    std::vector<SessionInput> inputList;
+    std::vector<uint32_t> changedList;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(block->m_mutex);
+            if (block->m_pendingInput.empty()) {
+                block->m_isScheduled = false;
+                return;
+            }
+            inputList.swap(block->m_pendingInput);
+        }
+        size_t invalidInputAmount = 0;
+        for (const SessionInput &input : inputList) {
+            if (input.m_session >= store->m_sessionAmount || input.m_rail < 0 || input.m_rail >= Board::railAmount || !std::isfinite(input.m_physicalOffset)) {
+                invalidInputAmount++;
+                continue;
+            }
+            uint16_t level = static_cast<uint16_t>(clamp(input.m_physicalOffset, 0, MAXIMUM_PHYSICAL_OFFSET_ON_RAIL) / Board::unitPhysicalOffset);
+            uint16_t *offset = &store->m_offset[input.m_rail * store->m_sessionStride + input.m_session];
+            if (*offset != level) {
+                *offset = level;
+                if (!store->m_isChanged[input.m_session]) {
+                    store->m_isChanged[input.m_session] = 1;
+                    changedList.push_back(input.m_session);
+                }
+            }
+        }
+        for (uint32_t session : changedList) {
+            store->m_isChanged[session] = 0;
+            evaluateSession(store, session);
+            for (size_t i = 0; i < engine->m_boardPool.size() && store->m_isComplete[session]; ++i) {
+                engine->m_completeAmount++;
+                if (engine->m_output) {
+                    std::lock_guard<std::mutex> lock(engine->m_outputMutex);
+                    fprintf(engine->m_output, "Session %u completed board %u\n", session, store->m_boardIndex[session]);
+                }
+                uint32_t boardIndex = static_cast<uint32_t>((store->m_boardIndex[session] + 1) % engine->m_boardPool.size());
+                dealSessionBoard(store, session, &engine->m_boardPool[boardIndex], boardIndex);
+                evaluateSession(store, session);
+            }
+        }
+        engine->m_inputAmount += inputList.size();
+        engine->m_invalidInputAmount += invalidInputAmount;
+        engine->m_evaluateAmount += changedList.size();
+        inputList.clear();
+        changedList.clear();
+    }
+}
+
+// Hand inputs to their blocks, runs of inputs of one block take the block lock once, a block without queued
+// task gets one on the worker it belongs to
+template <typename Board>
+void postSessionInput (SessionEngine<Board> *engine, const SessionInput *input, size_t inputAmount) {
+    size_t i = 0;
+    while (i < inputAmount) {
+        size_t blockIndex = std::min<size_t>(input[i].m_session / SESSION_BLOCK_SIZE, engine->m_blockAmount - 1);
+        SessionBlock *block = &engine->m_block[blockIndex];
+        bool isScheduling = false;
+        {
+            std::lock_guard<std::mutex> lock(block->m_mutex);
+            for (; i < inputAmount && std::min<size_t>(input[i].m_session / SESSION_BLOCK_SIZE, engine->m_blockAmount - 1) == blockIndex; ++i) {
+                block->m_pendingInput.push_back(input[i]);
+            }
+            isScheduling = !block->m_isScheduled;
+            block->m_isScheduled = true;
+        }
+        if (isScheduling) {
+            submitPoolTask(engine->m_pool, static_cast<int>(blockIndex % engine->m_pool->m_workerAmount), [engine, blockIndex] () {
+                processSessionBlock(engine, blockIndex);
+            });
+        }
+    }
+}
+
+// Host sessionAmount sessions on threadAmount workers, fed by the endpoint stream, or by synthetic players moving
+// a random rail by one level updateRate times per second each for SESSION_LOAD_SECOND seconds
+template <typename Board>
+int runSessionEngine (size_t sessionAmount, int threadAmount, uint64_t seed, double updateRate, const char *endpointPath, const PuzzleBank *bank) {
+    SensorSource endpoint;
+    if (endpointPath && !openSensorSource(&endpoint, endpointPath)) {
+        fprintf(stderr, "Cannot open endpoint %s\n", endpointPath);
+        return 1;
+    }
+    sessionAmount = std::max<size_t>(sessionAmount, 1);
+    SessionEngine<Board> *engine = new SessionEngine<Board>();
+    engine->m_pool = createWorkStealingPool(threadAmount);
+    engine->m_output = endpointPath ? stdout : nullptr;
+    engine->m_inputAmount = 0;
+    engine->m_invalidInputAmount = 0;
+    engine->m_evaluateAmount = 0;
+    engine->m_completeAmount = 0;
+
+    // Pool boards are the first boards of the puzzle bank, the rest are generated on the workers, board i from an
+    // engine seeded by (seed, i) as batch simulation does, none is complete at all-zero offsets
+    auto generateBegin = std::chrono::steady_clock::now();
+    engine->m_boardPool.resize(std::min<size_t>(sessionAmount, SESSION_BOARD_POOL_AMOUNT));
+    size_t bankBoardAmount = (bank && isPuzzleBankOf<Board>(bank)) ? std::min<size_t>(bank->m_header->m_recordAmount, engine->m_boardPool.size()) : 0;
+    for (size_t i = 0; i < bankBoardAmount; ++i) {
+        const PuzzleBankRecord<Board> *record = puzzleBankRecord<Board>(bank, i);
+        SessionBoard<Board> *board = &engine->m_boardPool[i];
+        for (int j = 0; j < Board::railAmount; ++j) {
+            board->m_activeBar[j] = record->m_activeBar[j];
+        }
+        for (int j = 0; j < Board::trackAmount; ++j) {
+            board->m_checkpoint[j] = record->m_trackStatusList[j].m_checkpoint;
+        }
+        board->m_startTrack = record->m_startTrack;
+        board->m_endTrack = record->m_endTrack;
+    }
+    for (size_t i = bankBoardAmount; i < engine->m_boardPool.size(); ++i) {
+        submitPoolTask(engine->m_pool, static_cast<int>(i), [engine, seed, i] () {
+            RandomEngine randomEngine;
+            seedRandomEngine(&randomEngine, seed + i * 0x9E3779B97F4A7C15ULL);
+            GameStatus<Board> *game = generateGame<Board>(&randomEngine);
+            updateGameInfo(game);
+            while (game->m_isComplete) {
+                regenerateGame(game, &randomEngine);
+                updateGameInfo(game);
+            }
+            SessionBoard<Board> *board = &engine->m_boardPool[i];
+            for (int j = 0; j < Board::railAmount; ++j) {
+                board->m_activeBar[j] = game->m_railStatusList[j].m_activeBar;
+            }
+            for (int j = 0; j < Board::trackAmount; ++j) {
+                board->m_checkpoint[j] = game->m_trackStatusList[j].m_checkpoint;
+            }
+            board->m_startTrack = static_cast<uint16_t>(game->m_startTrack);
+            board->m_endTrack = static_cast<uint16_t>(game->m_endTrack);
+            destroyGame(game);
+        });
+    }
+    waitPoolIdle(engine->m_pool);
+    double generateSecond = std::chrono::duration<double>(std::chrono::steady_clock::now() - generateBegin).count();
+
+    engine->m_store = createSessionStore<Board>(sessionAmount);
+    engine->m_blockAmount = engine->m_store->m_sessionStride / SESSION_BLOCK_SIZE;
+    engine->m_block = new SessionBlock[engine->m_blockAmount];
+    for (size_t i = 0; i < sessionAmount; ++i) {
+        uint32_t boardIndex = static_cast<uint32_t>(i % engine->m_boardPool.size());
+        dealSessionBoard(engine->m_store, i, &engine->m_boardPool[boardIndex], boardIndex);
+        evaluateSession(engine->m_store, i);
+    }
+    for (int i = 0; i < engine->m_pool->m_workerAmount; ++i) {
+        engine->m_pool->m_queue[i].m_busyNanosecond = 0;
+        engine->m_pool->m_queue[i].m_taskAmount = 0;
+        engine->m_pool->m_queue[i].m_stealAmount = 0;
     }
-    return railList;
-}
 
-#ifdef ONE_SET_CHECKPOINT_GENERATION
-bool isAdviceOffsetReachEnd (const GameStatus *game) {
-    int globalTrackTestPos = 0;
-    int currentTrack = game->m_startTrack; // 0 ~ TRACK_AMOUNT-1
-    while (globalTrackTestPos < MAXIMUM_INTERLEAVE_TRACK_POS) {
-        int switchToSide = 0; // 1 is right, -1 is left, 0 dont' move to either side
-
-        if (isRailInBoundary(RIGHT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset && globalTrackTestPos/2 < game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's right track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset;
-            if (game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 1) {
-                    switchToSide = 1;
-                }
-            }
+    auto loadBegin = std::chrono::steady_clock::now();
+    size_t postedAmount = 0;
+    std::vector<SessionInput> inputList(SESSION_INPUT_CAPACITY);
+    if (endpointPath) {
+        size_t inputAmount;
+        while ((inputAmount = readSessionInput(&endpoint, inputList.data(), inputList.size())) > 0) {
+            postSessionInput(engine, inputList.data(), inputAmount);
+            postedAmount += inputAmount;
         }
-        if (isRailInBoundary(LEFT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset && globalTrackTestPos/2 < game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's left track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset;
-            if (game->m_railStatusList[LEFT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack ^ globalTrackTestPos) & 1) == 0) {
-                    switchToSide = -1;
+    } else {
+        // Ticks of 10 ms, players take turns in session order so consecutive inputs share a block
+        const std::chrono::milliseconds tick(10);
+        std::vector<uint16_t> level(Board::railAmount * sessionAmount, 0);
+        RandomEngine randomEngine;
+        seedRandomEngine(&randomEngine, seed ^ 0x5E5510);
+        double inputCredit = 0;
+        size_t nextSession = 0;
+        auto tickTime = loadBegin;
+        while (tickTime - loadBegin < std::chrono::seconds(SESSION_LOAD_SECOND)) {
+            inputCredit += sessionAmount * updateRate * std::chrono::duration<double>(tick).count();
+            size_t tickInputAmount = static_cast<size_t>(inputCredit);
+            inputCredit -= tickInputAmount;
+            size_t inputAmount = 0;
+            for (size_t k = 0; k < tickInputAmount; ++k) {
+                SessionInput *input = &inputList[inputAmount++];
+                input->m_session = static_cast<uint32_t>(nextSession);
+                input->m_rail = static_cast<int>(randomBelow(&randomEngine, Board::railAmount));
+                uint16_t *railLevel = &level[nextSession * Board::railAmount + input->m_rail];
+                *railLevel = (*railLevel == 0 || (*railLevel < Board::barAmount && randomBelow(&randomEngine, 2))) ? *railLevel + 1 : *railLevel - 1;
+                input->m_physicalOffset = *railLevel < Board::barAmount ? (*railLevel + 0.5f) * Board::unitPhysicalOffset : MAXIMUM_PHYSICAL_OFFSET_ON_RAIL;
+                nextSession = (nextSession + 1) % sessionAmount;
+                if (inputAmount == inputList.size() || k + 1 == tickInputAmount) {
+                    postSessionInput(engine, inputList.data(), inputAmount);
+                    postedAmount += inputAmount;
+                    inputAmount = 0;
                 }
             }
+            tickTime += tick;
+            std::this_thread::sleep_until(tickTime);
         }
-        // switch current test track to left or right side or don't switch
-        currentTrack += switchToSide;
-        globalTrackTestPos++;
     }
+    waitPoolIdle(engine->m_pool);
+    double loadSecond = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadBegin).count();
+
+    uint64_t busyNanosecond = 0;
+    size_t taskAmount = 0;
+    size_t stealAmount = 0;
+    for (int i = 0; i < engine->m_pool->m_workerAmount; ++i) {
+        busyNanosecond += engine->m_pool->m_queue[i].m_busyNanosecond;
+        taskAmount += engine->m_pool->m_queue[i].m_taskAmount;
+        stealAmount += engine->m_pool->m_queue[i].m_stealAmount;
+    }
+    size_t inputAmount = std::max<size_t>(engine->m_inputAmount, 1);
+    double inputNanosecond = static_cast<double>(busyNanosecond) / inputAmount;
+    printf("Sessions: %zu on %d workers, %zu sessions per block, %zu pool boards (%zu from puzzle bank) ready in %lf(s)\n", sessionAmount, engine->m_pool->m_workerAmount, static_cast<size_t>(SESSION_BLOCK_SIZE), engine->m_boardPool.size(), bankBoardAmount, generateSecond);
+    printf("Seed: %llu\n", static_cast<unsigned long long>(seed));
+    printf("Board: %d rails, %d bars, %d checkpoints, %zu bytes per session\n", Board::railAmount, Board::barAmount, Board::checkpointAmount, SessionStore<Board>::sessionByte);
+    printf("Inputs: %zu posted, %zu processed (%lf per second) in %lf(s), %zu invalid, %zu session evaluations\n", postedAmount, engine->m_inputAmount.load(), engine->m_inputAmount / loadSecond, loadSecond, engine->m_invalidInputAmount.load(), engine->m_evaluateAmount.load());
+    printf("Tasks: %zu, %zu stolen, workers busy %lf(s), %lf(ns) per input\n", taskAmount, stealAmount, busyNanosecond * 1e-9, inputNanosecond);
+    printf("Completed boards: %zu\n", engine->m_completeAmount.load());
+    printf("Sessions per core at %lf updates per second: %lf\n", updateRate, 1e9 / (inputNanosecond * std::max(updateRate, 1e-9)));
 
-    return currentTrack == game->m_endTrack;
+    destroyWorkStealingPool(engine->m_pool);
+    delete [] engine->m_block;
+    destroySessionStore(engine->m_store);
+    delete engine;
+    return 0;
 }
 
-void updateAdviceAnswerTrackPath (GameStatus *game) {
-    int globalTrackTestPos = 0;
-    int currentTrack = game->m_startTrack; // 0 ~ TRACK_AMOUNT-1
-    while (globalTrackTestPos < MAXIMUM_INTERLEAVE_TRACK_POS) {
-        // update advice track
-        game->m_adviceAnswerTrackPath[globalTrackTestPos] = currentTrack;
-        int switchToSide = 0; // 1 is right, -1 is left, 0 dont' move to either side
+// Input trace
+// Binary log of a game session, replayed without terminal to reproduce a session or measure it.
+// Header is magic, version, rail amount, seed, board digest and engine state after the first board, then the
+// board: active bars of each rail, checkpoints of each track, start and end track and advice offsets. Then one
+// record per game loop wakeup: nanoseconds since previous record, wakeup events, and on input the current input
+// rail and the rails whose physical offset changed. Integers are LEB128 varints, fixed width fields and float
+// bits are little endian.
+#define INPUT_TRACE_MAGIC "GLTR"
+#define INPUT_TRACE_VERSION 2
 
-        if (isRailInBoundary(RIGHT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's right track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset;
-            if (game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 1) {
-                    switchToSide = 1;
-                }
-            }
-        }
-        if (isRailInBoundary(LEFT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's left track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset;
-            if (game->m_railStatusList[LEFT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 0) {
-                    switchToSide = -1;
-                }
-            }
-        }
-        // switch current test track to left or right side or don't switch
-        currentTrack += switchToSide;
-        globalTrackTestPos++;
+typedef struct InputTraceHeader {
+    uint32_t m_version;
+
+    int m_railAmount;
+
+    uint64_t m_seed;
+
+    // Rails, start track and end track of the first board, replay refuses a board that doesn't match it
+    uint64_t m_boardDigest;
+
+    // Checkpoint regenerations draw from here on, whether the board was generated or taken from a bank
+    RandomEngine m_engine;
+
+} InputTraceHeader;
+
+template <typename Board>
+struct InputTraceRecord {
+    // Nanosecond since session start, the now handed to eventDrivenCheckpointUpdate()
+    uint64_t m_time;
+
+    // INPUT_EVENT and CHECKPOINT_EVENT the game loop woke up with, TIMER_EVENT if timers regenerated checkpoints
+    uint32_t m_event;
+
+    int m_currentInputRail;
+
+    InputStatus<Board> m_inputStatus;
+
+};
+
+// Reader or writer state, records are delta coded against the previous one
+template <typename Board>
+struct InputTraceStream {
+    FILE *m_file;
+
+    uint64_t m_lastTime;
+
+    InputStatus<Board> m_lastInputStatus;
+
+    size_t m_recordAmount;
+
+    InputTraceStream() : m_file(nullptr), m_lastTime(0), m_recordAmount(0) { }
+
+};
+
+void digestValue (uint64_t *digest, uint64_t value) {
+    // FNV-1a over the 8 bytes of value
+    for (int i = 0; i < 8; ++i) {
+        *digest = (*digest ^ ((value >> (8 * i)) & 0xFF)) * 0x100000001B3ULL;
     }
 }
 
-void findAdmissibleAnswer (GameStatus *game) {
-    // this will update game->m_railStatusList->m_adviceCompleteOffset and game->m_adviceAnswerTrackPath
+template <typename Board>
+uint64_t boardDigest (const GameStatus<Board> *game) {
+    uint64_t digest = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < Board::railAmount; ++i) {
+        forEachMaskBit(game->m_railStatusList[i].m_activeBar, [&] (int bar) {
+            digestValue(&digest, (static_cast<uint64_t>(i) << 32) | bar);
+        });
+    }
+    digestValue(&digest, game->m_startTrack);
+    digestValue(&digest, game->m_endTrack);
+    return digest;
+}
+
+// Offsets, checkpoints and progress after a replay, equal digests mean equal sessions
+template <typename Board>
+uint64_t gameStateDigest (const GameStatus<Board> *game) {
+    uint64_t digest = boardDigest(game);
+    for (int i = 0; i < Board::railAmount; ++i) {
+        digestValue(&digest, game->m_railStatusList[i].m_offset);
+        digestValue(&digest, game->m_railStatusList[i].m_adviceCompleteOffset);
+    }
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        forEachMaskBit(game->m_trackStatusList[i].m_checkpoint, [&] (int trackPos) {
+            digestValue(&digest, (static_cast<uint64_t>(i) << 32) | trackPos);
+        });
+    }
+    uint32_t progressBit;
+    memcpy(&progressBit, &game->m_progressBar, sizeof(progressBit));
+    digestValue(&digest, progressBit);
+    digestValue(&digest, game->m_achievedCheckpoint);
+    digestValue(&digest, game->m_isComplete ? 1 : 0);
+    return digest;
+}
+
+void writeVarint (FILE *file, uint64_t value) {
     do {
-        for (int i = 0; i < SLIDING_RAIL_AMOUNT; ++i) {
-            game->m_railStatusList[i].m_adviceCompleteOffset = (uint32_t)(randomFloat() * MAXIMUM_BAR);
-        }
-    } while (!isAdviceOffsetReachEnd(game));
-    updateAdviceAnswerTrackPath(game);
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        fputc(byte | (value ? 0x80 : 0), file);
+    } while (value);
 }
 
-void useAdmissibleAnswerToTagCheckpoint(GameStatus *game) {
-    int globalTrackTestPos = 0;
-    int currentTrack = game->m_startTrack; // 0 ~ TRACK_AMOUNT-1
-    // checkpointAmount + 1, plus one is to prevent from choosing checkpoint at end point
-    int checkpointSpacing = (MAXIMUM_INTERLEAVE_TRACK_POS - 1) / CHECKPOINT_AMOUNT;
-    while (globalTrackTestPos < MAXIMUM_INTERLEAVE_TRACK_POS) {
-        int switchToSide = 0; // 1 is right, -1 is left, 0 dont' move to either side
-
-        if (isRailInBoundary(RIGHT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset && globalTrackTestPos/2 < game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's right track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_adviceCompleteOffset;
-            if (game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 1) {
-                    switchToSide = 1;
-                }
-            }
+bool readVarint (FILE *file, uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = fgetc(file);
+        if (byte == EOF) {
+            return false;
         }
-        if (isRailInBoundary(LEFT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset && globalTrackTestPos/2 < game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's left track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[LEFT_RAIL(currentTrack)].m_adviceCompleteOffset;
-            if (game->m_railStatusList[LEFT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 0) {
-                    switchToSide = -1;
-                }
-            }
-        }
-        // switch current test track to left or right side or don't switch
-        currentTrack += switchToSide;
-        globalTrackTestPos++;
-        // Generate checkpoint
-        if (globalTrackTestPos % checkpointSpacing == 0) {
-            game->m_trackStatusList[currentTrack].m_checkpoint = (game->m_trackStatusList[currentTrack].m_checkpoint | MASK_AT(globalTrackTestPos));
+        *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
         }
     }
+    return false;
 }
 
-void updateCheckpoint (TrackStatus *trackList, GameStatus *game) {
-    for (int i = 0; i < TRACK_AMOUNT; ++i) {
-        trackList[i].m_checkpoint = 0;
+void writeFixed (FILE *file, uint64_t value, int byteAmount) {
+    for (int i = 0; i < byteAmount; ++i) {
+        fputc((value >> (8 * i)) & 0xFF, file);
     }
-    findAdmissibleAnswer(game);
-    useAdmissibleAnswerToTagCheckpoint(game);
 }
-#endif
-#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
-void updateCheckpoint (TrackStatus *trackList, GameStatus *game) {
-    for (int i = 0; i < TRACK_AMOUNT; ++i) {
-        trackList[i].m_checkpoint = 0;
-        for (int j = 0; j < MAXIMUM_INTERLEAVE_TRACK_POS; ++j) {
-            if (randomFloat() <= CHECKPOINT_GENERATE_PROBABILITY) {
-                trackList[i].m_checkpoint = trackList[i].m_checkpoint | MASK_AT(j);
-            }
+
+bool readFixed (FILE *file, uint64_t *value, int byteAmount) {
+    *value = 0;
+    for (int i = 0; i < byteAmount; ++i) {
+        int byte = fgetc(file);
+        if (byte == EOF) {
+            return false;
         }
+        *value |= static_cast<uint64_t>(byte) << (8 * i);
     }
+    return true;
 }
-bool isAnswerExist () {
-    // TODO
+
+void writeInputTraceHeader (FILE *file, const InputTraceHeader *header) {
+    fwrite(INPUT_TRACE_MAGIC, 1, 4, file);
+    writeFixed(file, header->m_version, 4);
+    writeFixed(file, header->m_railAmount, 4);
+    writeFixed(file, header->m_seed, 8);
+    writeFixed(file, header->m_boardDigest, 8);
+    uint64_t engineWord[sizeof(RandomEngine) / sizeof(uint64_t)];
+    memcpy(engineWord, &header->m_engine, sizeof(engineWord));
+    for (size_t i = 0; i < sizeof(RandomEngine) / sizeof(uint64_t); ++i) {
+        writeFixed(file, engineWord[i], 8);
+    }
 }
-#endif
 
-TrackStatus *generateCheckpoint (GameStatus *game) {
-    // DYNAMIC: Declare rail status memory space and initialize it
-    TrackStatus *trackList = new TrackStatus[TRACK_AMOUNT]();
-    game->m_trackStatusList = trackList;
-    updateCheckpoint(trackList, game);
-    // TODO need sanity check to ensure there is always at least one answer exist in MULTIPLE_SET_CHECKPOINT_GENERATION situation
+bool readInputTraceHeader (FILE *file, InputTraceHeader *header) {
+    char magic[4];
+    uint64_t version, railAmount;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, INPUT_TRACE_MAGIC, 4) != 0 ||
+        !readFixed(file, &version, 4) || !readFixed(file, &railAmount, 4)) {
+        return false;
+    }
+    header->m_version = static_cast<uint32_t>(version);
+    header->m_railAmount = static_cast<int>(railAmount);
+    if (header->m_version != INPUT_TRACE_VERSION || !readFixed(file, &header->m_seed, 8) || !readFixed(file, &header->m_boardDigest, 8)) {
+        return false;
+    }
+    uint64_t engineWord[sizeof(RandomEngine) / sizeof(uint64_t)];
+    for (size_t i = 0; i < sizeof(RandomEngine) / sizeof(uint64_t); ++i) {
+        if (!readFixed(file, &engineWord[i], 8)) {
+            return false;
+        }
+    }
+    memcpy(&header->m_engine, engineWord, sizeof(engineWord));
+    return true;
+}
 
-    return trackList;
+template <typename Mask>
+void writeMaskBit (FILE *file, const Mask &mask) {
+    writeVarint(file, maskBitCount(mask));
+    forEachMaskBit(mask, [&] (int i) {
+        writeVarint(file, i);
+    });
 }
 
-#ifdef CHECKPOINT_TRIGGER_EVENT
-void updateTriggerCheckpoint (GameStatus *game, float triggerCheckpointGenProb) {
-    for (int i = 0; i < TRACK_AMOUNT; ++i) {
-        game->m_trackStatusList[i].m_triggerCheckpoint = 0;
-        for (int j = 0; j < MAXIMUM_INTERLEAVE_TRACK_POS; ++j) {
-            if ((game->m_trackStatusList[i].m_checkpoint & MASK_AT(j)) && randomFloat() <= triggerCheckpointGenProb) {
-                game->m_trackStatusList[i].m_triggerCheckpoint = game->m_trackStatusList[i].m_triggerCheckpoint | MASK_AT(j);
-            }
+// Return false if the mask is truncated or has a bit from bitAmount on
+template <typename Mask>
+bool readMaskBit (FILE *file, Mask *mask, int bitAmount) {
+    uint64_t setAmount, bit;
+    if (!readVarint(file, &setAmount) || setAmount > static_cast<uint64_t>(bitAmount)) {
+        return false;
+    }
+    *mask = Mask();
+    for (uint64_t i = 0; i < setAmount; ++i) {
+        if (!readVarint(file, &bit) || bit >= static_cast<uint64_t>(bitAmount)) {
+            return false;
         }
+        setMaskBit(mask, static_cast<int>(bit));
     }
+    return true;
 }
-#endif
 
-GameStatus *generateGame() {
-    GameStatus *game = new GameStatus();
-    game->m_startTrack = floor(randomFloat() * SLIDING_RAIL_AMOUNT);
-    game->m_endTrack = floor(randomFloat() * SLIDING_RAIL_AMOUNT);
-    game->m_railStatusList = generateGhostLegGraph();
-    game->m_trackStatusList = generateCheckpoint(game);
+// Flushed with the header, the board is written once before the first record
+template <typename Board>
+void writeInputTraceBoard (FILE *file, const GameStatus<Board> *game) {
+    for (int i = 0; i < Board::railAmount; ++i) {
+        writeMaskBit(file, game->m_railStatusList[i].m_activeBar);
+    }
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        writeMaskBit(file, game->m_trackStatusList[i].m_checkpoint);
 #ifdef CHECKPOINT_TRIGGER_EVENT
-    updateTriggerCheckpoint(game, TRIGGER_CHECKPOINT_PROBABILITY);
+        writeMaskBit(file, game->m_trackStatusList[i].m_triggerCheckpoint);
 #endif
-    game->m_progressBar = .0f;
-    return game;
+    }
+    writeVarint(file, game->m_startTrack);
+    writeVarint(file, game->m_endTrack);
+    for (int i = 0; i < Board::railAmount; ++i) {
+        writeVarint(file, game->m_railStatusList[i].m_adviceCompleteOffset);
+    }
+    fflush(file);
 }
 
-float progressBarUpdate(GameStatus *game) {
-
-#ifdef ONE_SET_CHECKPOINT_GENERATION
-    int globalTrackTestPos = 0;
-    int currentTrack = game->m_startTrack; // 0 ~ TRACK_AMOUNT-1
-    int checkpointSpacing = (MAXIMUM_INTERLEAVE_TRACK_POS - 1) / CHECKPOINT_AMOUNT;
-    int currentAchievedCheckpointTrack;
-    int currentAchievedCheckpointPos;
-    int latestAchievedCheckpoint = 0;
-    while (globalTrackTestPos < MAXIMUM_INTERLEAVE_TRACK_POS) {
-        if ((latestAchievedCheckpoint + 1) * checkpointSpacing == globalTrackTestPos) {
-            if ((game->m_trackStatusList[currentTrack].m_checkpoint & MASK_AT(globalTrackTestPos))) {
-                currentAchievedCheckpointTrack = currentTrack;
-                currentAchievedCheckpointPos = globalTrackTestPos;
-                latestAchievedCheckpoint++;
-            } else {
-                break;
-            }
+// Board in the storage of a finished one as the trace describes it, the tables generation derives are rebuilt.
+// Return false on a truncated or out of range board.
+template <typename Board>
+bool readInputTraceBoard (FILE *file, GameStatus<Board> *game) {
+    new (game) GameStatus<Board>();
+    for (int i = 0; i < Board::railAmount; ++i) {
+        if (!readMaskBit(file, &game->m_railStatusList[i].m_activeBar, Board::barAmount)) {
+            return false;
         }
-
-        int switchToSide = 0; // 1 is right, -1 is left, 0 dont' move to either side
-        if (isRailInBoundary(RIGHT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's right track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset;
-            if (game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 1) {
-                    switchToSide = 1;
-                }
-            }
+    }
+    for (int i = 0; i < Board::trackAmount; ++i) {
+        if (!readMaskBit(file, &game->m_trackStatusList[i].m_checkpoint, Board::interleaveTrackPosAmount)) {
+            return false;
         }
-        if (isRailInBoundary(LEFT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's left track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset;
-            if (game->m_railStatusList[LEFT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 0) {
-                    switchToSide = -1;
-                }
-            }
+#ifdef CHECKPOINT_TRIGGER_EVENT
+        if (!readMaskBit(file, &game->m_trackStatusList[i].m_triggerCheckpoint, Board::interleaveTrackPosAmount)) {
+            return false;
         }
-        // switch current test track to left or right side or don't switch
-        currentTrack += switchToSide;
-        globalTrackTestPos++;
+#endif
     }
-  #ifdef CHECKPOINT_TO_CHECKPOINT_DISTANCE
-    // TODO still thinking about how to get the path distance to next checkpoint 0.0
-    if (currentAchievedCheckpointTrack >= checkpointSpacing * CHECKPOINT_AMOUNT) {
-        // Achieved last checkpoint and is seeking for the end point
-        int verticalLength = MAXIMUM_INTERLEAVE_TRACK_POS - currentAchievedCheckpointPos;
-        // DISCUSS: Should we amplify the impact of horizontalLength(?
-        int horizontalLength = game->m_endTrack - currentAchievedCheckpointTrack;
-        game->m_progressBar = sqrt(verticalLength * verticalLength + horizontalLength * horizontalLength);
-    } else {
-        // // Didn't achieve last checkpoint
-        // int verticalLength = 32 - currentAchievedCheckpointPos;
-        // // DISCUSS: Should we amplify the impact of horizontalLength(?
-        // int horizontalLength = m_adviceAnswerTrackPath[currentAchievedCheckpointTrack] - currentAchievedCheckpointTrack;
-        // game->m_progressBar = sqrt(verticalLength * verticalLength + horizontalLength * horizontalLength);
+    uint64_t startTrack, endTrack, adviceOffset;
+    if (!readVarint(file, &startTrack) || !readVarint(file, &endTrack) ||
+        startTrack >= static_cast<uint64_t>(Board::trackAmount) || endTrack >= static_cast<uint64_t>(Board::trackAmount)) {
+        return false;
     }
-  #endif
-  #ifdef CHECKPOINT_TO_ENDTRACK_DISTANCE
-    globalTrackTestPos = latestAchievedCheckpoint * checkpointSpacing;
-    while (globalTrackTestPos < MAXIMUM_INTERLEAVE_TRACK_POS) {
-        if (currentTrack == game->m_adviceAnswerTrackPath[globalTrackTestPos] || globalTrackTestPos >= (latestAchievedCheckpoint + 1) * checkpointSpacing) {
-            break;
+    game->m_startTrack = static_cast<size_t>(startTrack);
+    game->m_endTrack = static_cast<size_t>(endTrack);
+    for (int i = 0; i < Board::railAmount; ++i) {
+        if (!readVarint(file, &adviceOffset) || adviceOffset >= static_cast<uint64_t>(Board::offsetLevelAmount)) {
+            return false;
         }
+        game->m_railStatusList[i].m_adviceCompleteOffset = static_cast<size_t>(adviceOffset);
+    }
+    rebuildGameTable(game);
+    return true;
+}
 
-        int switchToSide = 0; // 1 is right, -1 is left, 0 dont' move to either side
-
-        if (isRailInBoundary(RIGHT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's right track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset;
-            if (game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 1) {
-                    switchToSide = 1;
-                }
-            }
+// Flushed per record, so a crashed or killed session still leaves every wakeup before it
+template <typename Board>
+void writeInputTraceRecord (InputTraceStream<Board> *stream, const InputTraceRecord<Board> *record) {
+    FILE *file = stream->m_file;
+    writeVarint(file, record->m_time - stream->m_lastTime);
+    writeVarint(file, record->m_event);
+    if (record->m_event & INPUT_EVENT) {
+        int changedRailAmount = 0;
+        for (int i = 0; i < Board::railAmount; ++i) {
+            changedRailAmount += (record->m_inputStatus.m_physicalOffset[i] != stream->m_lastInputStatus.m_physicalOffset[i]) ? 1 : 0;
         }
-        if (isRailInBoundary(LEFT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's left track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset;
-            if (game->m_railStatusList[LEFT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 0) {
-                    switchToSide = -1;
-                }
+        writeVarint(file, record->m_currentInputRail);
+        writeVarint(file, changedRailAmount);
+        for (int i = 0; i < Board::railAmount; ++i) {
+            if (record->m_inputStatus.m_physicalOffset[i] != stream->m_lastInputStatus.m_physicalOffset[i]) {
+                uint32_t offsetBit;
+                memcpy(&offsetBit, &record->m_inputStatus.m_physicalOffset[i], sizeof(offsetBit));
+                writeVarint(file, i);
+                writeFixed(file, offsetBit, 4);
             }
         }
-        // switch current test track to left or right side or don't switch
-        currentTrack += switchToSide;
-        globalTrackTestPos++;
-    }
-    if (latestAchievedCheckpoint >= CHECKPOINT_AMOUNT) {
-        // Issue: ProgressBar update
-        // Achieved last checkpoint and is seeking for the end point
-        // The tri-operator is for detecting if there is no contact with right end track
-        int toEndTrackLength = (MAXIMUM_INTERLEAVE_TRACK_POS - globalTrackTestPos) <= 0 ? checkpointSpacing : (MAXIMUM_INTERLEAVE_TRACK_POS - globalTrackTestPos);
-        game->m_progressBar = 1.0f - (static_cast<float>(toEndTrackLength) / static_cast<float>(checkpointSpacing));
-    } else {
-        // Didn't achieve last checkpoint
-        int toEndTrackLength = (latestAchievedCheckpoint + 1) * checkpointSpacing - globalTrackTestPos;
-        // if the globalTrackTestPos isn't even touch the next checkpoint, then toEndTrackLength will appear to be 0
-        if (toEndTrackLength == 0) {
-            game->m_progressBar = 0.0f;
-        } else {
-            game->m_progressBar = 1.0f - (static_cast<float>(toEndTrackLength) / static_cast<float>(checkpointSpacing));
-        }
+        stream->m_lastInputStatus = record->m_inputStatus;
     }
-    game->m_debug = globalTrackTestPos;
-  #endif
-#endif
-
-#ifdef MULTIPLE_SET_CHECKPOINT_GENERATION
-  #ifdef TO_MAXIMUM_CHECKPOINT_DISTANCE
-      game->m_progressBar = clamp(static_cast<float>(game->m_achievedCheckpoint / MAXIMUM_FULFILL_CHECKPOINT), .0f, 1.0f);
-  #endif
-#endif
+    fflush(file);
+    stream->m_lastTime = record->m_time;
+    stream->m_recordAmount++;
 }
 
-void updateGameInfo(GameStatus *game) {
-    // Should use 64 position to accurately present its behavior
-    int globalTrackTestPos = 0;
-    int currentTrack = game->m_startTrack; // 0 ~ TRACK_AMOUNT-1
-    game->m_achievedCheckpoint = 0;
-#ifdef CHECKPOINT_TRIGGER_EVENT
-    game->m_isTriggerCheckpoint = false;
-#endif
-    while (globalTrackTestPos < MAXIMUM_INTERLEAVE_TRACK_POS) {
-        // For debug purpose
-        game->m_currentTrackHistory[globalTrackTestPos] = currentTrack;
-
-        game->m_achievedCheckpoint += (game->m_trackStatusList[currentTrack].m_checkpoint & MASK_AT(globalTrackTestPos)) ? 1 : 0;
-
-#ifdef CHECKPOINT_TRIGGER_EVENT
-        game->m_isTriggerCheckpoint = std::max(game->m_isTriggerCheckpoint, (game->m_trackStatusList[currentTrack].m_triggerCheckpoint & MASK_AT(globalTrackTestPos)) ? true : false);
-#endif
-
-        int switchToSide = 0; // 1 is right, -1 is left, 0 dont' move to either side
-
-        if (isRailInBoundary(RIGHT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's right track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_offset;
-            if (game->m_railStatusList[RIGHT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack & 1) ^ (globalTrackTestPos & 1)) == 1) {
-                    switchToSide = 1;
-                }
-            }
+// Return false at end of trace or on a truncated record
+template <typename Board>
+bool readInputTraceRecord (InputTraceStream<Board> *stream, InputTraceRecord<Board> *record) {
+    FILE *file = stream->m_file;
+    uint64_t timeDelta, event;
+    if (!readVarint(file, &timeDelta) || !readVarint(file, &event)) {
+        return false;
+    }
+    record->m_time = stream->m_lastTime + timeDelta;
+    record->m_event = static_cast<uint32_t>(event);
+    record->m_inputStatus = stream->m_lastInputStatus;
+    if (record->m_event & INPUT_EVENT) {
+        uint64_t currentInputRail, changedRailAmount;
+        if (!readVarint(file, &currentInputRail) || !readVarint(file, &changedRailAmount)) {
+            return false;
         }
-        if (isRailInBoundary(LEFT_RAIL(currentTrack)) && globalTrackTestPos/2 >= game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset && globalTrackTestPos/2 < game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset + MAXIMUM_BAR) {
-            // Mapping global test pos to current rail's left track local test pos
-            int localTrackTestPos = globalTrackTestPos/2 - game->m_railStatusList[LEFT_RAIL(currentTrack)].m_offset;
-            if (game->m_railStatusList[LEFT_RAIL(currentTrack)].m_activeBar & MASK_AT(localTrackTestPos)) {
-                if (((currentTrack ^ globalTrackTestPos) & 1) == 0) {
-                    switchToSide = -1;
-                }
+        record->m_currentInputRail = static_cast<int>(currentInputRail);
+        for (uint64_t i = 0; i < changedRailAmount; ++i) {
+            uint64_t rail, offsetBit;
+            if (!readVarint(file, &rail) || !readFixed(file, &offsetBit, 4) || rail >= static_cast<uint64_t>(Board::railAmount)) {
+                return false;
             }
+            uint32_t offsetWord = static_cast<uint32_t>(offsetBit);
+            memcpy(&record->m_inputStatus.m_physicalOffset[rail], &offsetWord, sizeof(offsetWord));
         }
-        // switch current test track to left or right side or don't switch
-        currentTrack += switchToSide;
-        globalTrackTestPos++;
+        stream->m_lastInputStatus = record->m_inputStatus;
     }
-    game->m_currentEndTrack = currentTrack;
-    game->m_isComplete = (game->m_endTrack == currentTrack) && (game->m_achievedCheckpoint >= CHECKPOINT_AMOUNT);
-
-    progressBarUpdate(game);
+    stream->m_lastTime = record->m_time;
+    stream->m_recordAmount++;
+    return true;
 }
 
-void eventDrivenCheckpointUpdate(int currentTime, GameStatus *game) {
-#ifdef TIME_TRIGGER_EVENT
-    // NOTICE: Make sure to invoke this routine every second
-    if (currentTime != 0 && currentTime % TIME_TRIGGER_INTERVAL == 0) {
-        updateCheckpoint(game->m_trackStatusList, game);
-    }
-#endif
-
-#ifdef CHECKPOINT_TRIGGER_EVENT
-    // NOTICE: should called after updateGameInfo()
-    if (game->m_isTriggerCheckpoint) {
-        updateCheckpoint(game->m_trackStatusList, game);
+// Feed a trace through the game loop steps of runGame() with the recorded times, sleeping until each one in
+// real time mode, otherwise as fast as possible on a virtual clock
+template <typename Board>
+int runReplay (FILE *file, const InputTraceHeader *header, bool isRealTime) {
+    RandomEngine engine = header->m_engine;
+    GameStatus<Board> *game = new GameStatus<Board>;
+    if (!readInputTraceBoard(file, game) || boardDigest(game) != header->m_boardDigest) {
+        fprintf(stderr, "Trace board is truncated or doesn't match its digest\n");
+        destroyGame(game);
+        return 1;
     }
-#endif
-}
 
-GraphProperty drawInterleavedTrackAt(const GameStatus *game, int trackId, int trackPos) {
-    // With color ver.
-    #ifdef TOGGLE_SOLUTION
-    if (game->m_adviceAnswerTrackPath[trackPos] == trackId) {
-        if (game->m_trackStatusList[trackId].m_checkpoint & MASK_AT(trackPos)) {
-            return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::YELLOW);
-        } else {
-            return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::BLUE);
+    InputTraceStream<Board> stream;
+    stream.m_file = file;
+    InputTraceRecord<Board> record;
+    TimerScheduler scheduler;
+    auto replayBegin = std::chrono::steady_clock::now();
+    initCheckpointTimer(&scheduler, replayBegin);
+    size_t inputAmount = 0;
+    size_t regenerateAmount = 0;
+    // Wakeups whose checkpoint regeneration differs from the recorded one
+    size_t divergedAmount = 0;
+    double completeSecond = -1;
+    // Only the game loop stages are replayed, there is no queue or screen
+    LatencyRecorder *latencyRecorder = new LatencyRecorder();
+    while (readInputTraceRecord(&stream, &record)) {
+        auto now = replayBegin + std::chrono::nanoseconds(record.m_time);
+        if (isRealTime) {
+            std::this_thread::sleep_until(now);
+        }
+        auto stageBegin = std::chrono::steady_clock::now();
+        if (record.m_event & INPUT_EVENT) {
+            railInputUpdate(&record.m_inputStatus, game);
+            auto railUpdated = std::chrono::steady_clock::now();
+            recordLatency(&latencyRecorder->m_stage[RAIL_INPUT_UPDATE_STAGE], railUpdated - stageBegin);
+            stageBegin = railUpdated;
+            inputAmount++;
+        }
+        if (record.m_event & (INPUT_EVENT | CHECKPOINT_EVENT)) {
+            updateGameInfo(game);
+            recordLatency(&latencyRecorder->m_stage[UPDATE_GAME_INFO_STAGE], std::chrono::steady_clock::now() - stageBegin);
+        }
+        bool isRegenerated = eventDrivenCheckpointUpdate(&scheduler, game, &engine, now);
+        regenerateAmount += isRegenerated ? 1 : 0;
+        divergedAmount += (isRegenerated != ((record.m_event & TIMER_EVENT) != 0)) ? 1 : 0;
+        if (game->m_isComplete && completeSecond < 0) {
+            completeSecond = record.m_time * 1e-9;
         }
-    } else
-    #endif
-    #ifdef CHECKPOINT_TRIGGER_EVENT
-    if (game->m_trackStatusList[trackId].m_triggerCheckpoint & MASK_AT(trackPos)) {
-        return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::RED);
-    } else
-    #endif
-    if (game->m_trackStatusList[trackId].m_checkpoint & MASK_AT(trackPos)) {
-        return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::GREEN);
-    } else {
-        return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::WHITE);
     }
-    // Without color ver.
-    // return GraphProperty(GraphProperty::GraphIcon::BAR, GraphProperty::GraphColor::WHITE);
-}
+    double replaySecond = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayBegin).count();
 
-GraphProperty drawInterleavedRailAt(const GameStatus *game, int railId, int trackPos) {
-    // If trackPos is not on interleaved possible bar area, then it must print space
-    if (((railId&1) ^ (trackPos&1)) == 0) {
-        return GraphProperty(GraphProperty::GraphIcon::SPACE, GraphProperty::GraphColor::WHITE);
-    }
-    int barPhysicalPos = (trackPos - 2 * game->m_railStatusList[railId].m_offset);
-    if (barPhysicalPos >= 0) {
-        // prevent barPhysicalPos=-1 from divide it with 2 and get zero
-        int barLogicalPos = barPhysicalPos / 2;
-        if (game->m_railStatusList[railId].m_activeBar & MASK_AT(barLogicalPos)) {
-            return GraphProperty(GraphProperty::GraphIcon::DASH, GraphProperty::GraphColor::WHITE);
-        } else {
-            return GraphProperty(GraphProperty::GraphIcon::SPACE, GraphProperty::GraphColor::WHITE);
-        }
+    printf("Replayed %zu records of seed %llu on %d rails in %lf(s), %lf records per second, %s\n", stream.m_recordAmount,
+        static_cast<unsigned long long>(header->m_seed), Board::railAmount, replaySecond, stream.m_recordAmount / std::max(replaySecond, 1e-9), isRealTime ? "real time" : "as fast as possible");
+    printf("Trace covers %lf(s): %zu inputs, %zu checkpoint regenerations, %zu diverged wakeups\n", stream.m_lastTime * 1e-9, inputAmount, regenerateAmount, divergedAmount);
+    // Same progress bar as the last frame the recorded game published
+    refreshGameProgress(game);
+    if (completeSecond >= 0) {
+        printf("Completed at %lf(s)\n", completeSecond);
     } else {
-        return GraphProperty(GraphProperty::GraphIcon::SPACE, GraphProperty::GraphColor::WHITE);
+        printf("Not completed, achieved checkpoint amount is %d, progress bar %f\n", game->m_achievedCheckpoint, game->m_progressBar);
     }
+    printf("Final state digest %016llx\n", static_cast<unsigned long long>(gameStateDigest(game)));
+    printLatencyReport(stdout, latencyRecorder);
+    delete latencyRecorder;
+    destroyGame(game);
+    return divergedAmount == 0 ? 0 : 1;
 }
 
-void printGraph (const GameStatus *game) {
-    GraphProperty graph[SLIDING_RAIL_AMOUNT + TRACK_AMOUNT][2 * MAXIMUM_TRACK_POS];
-    for (int j = 0; j < MAXIMUM_INTERLEAVE_TRACK_POS; ++j) {
-        for (int i = 0; i < SLIDING_RAIL_AMOUNT; ++i) {
-            graph[i * 2][j] = drawInterleavedTrackAt(game, i, j);
-            graph[i * 2 + 1][j] = drawInterleavedRailAt(game, i, j);
-        }
-        graph[SLIDING_RAIL_AMOUNT+TRACK_AMOUNT-1][j] = drawInterleavedTrackAt(game, TRACK_AMOUNT-1, j);
-    }
+// benchmark.cpp includes this file with SIMULATE_NO_MAIN to reuse everything above
+#ifndef SIMULATE_NO_MAIN
+// Interactive game on one board size, seed replays the same boards and checkpoints
+// Every game loop wakeup is recorded to tracePath unless it's nullptr, rails are read from sensorPath instead of
+// arrow keys unless it's nullptr
+template <typename Board>
+int runGame (uint64_t seed, const char *tracePath, const char *sensorPath, const PuzzleBank *bank, int bankBucket) {
+    // Game loop is the only generator after initialization
+    RandomEngine engine;
+    seedRandomEngine(&engine, seed);
 
-#ifdef TRANSPOSE_GUI
-    for (int i = 0; i < SLIDING_RAIL_AMOUNT + TRACK_AMOUNT; ++i) {
-        for (int j = 0; j < MAXIMUM_INTERLEAVE_TRACK_POS; ++j) {
-            graph[i][j].print(true);
-        }
-        puts("");
+    // Initialize
+    if (bank && !isPuzzleBankOf<Board>(bank)) {
+        fprintf(stderr, "Puzzle bank holds %d rails boards of another build, boards are generated\n", bank->m_header->m_railAmount);
     }
-#else
-    for (int j = 0; j < MAXIMUM_INTERLEAVE_TRACK_POS; ++j) {
-        for (int i = 0; i < SLIDING_RAIL_AMOUNT + TRACK_AMOUNT; ++i) {
-            graph[i][j].print(false);
+    GameStatus<Board> *game = generateRoundGame<Board>(bank, bankBucket, &engine);
+    InputStatus<Board> *inputStatus = new InputStatus<Board>();
+
+    // Only game loop writes the trace, it stays open until the process exits
+    InputTraceStream<Board> traceStream;
+    if (tracePath) {
+        traceStream.m_file = fopen(tracePath, "wb");
+        if (!traceStream.m_file) {
+            fprintf(stderr, "Cannot open %s\n", tracePath);
+            return 1;
         }
-        puts("");
+        InputTraceHeader header = {INPUT_TRACE_VERSION, Board::railAmount, seed, boardDigest(game), engine};
+        writeInputTraceHeader(traceStream.m_file, &header);
+        writeInputTraceBoard(traceStream.m_file, game);
     }
-#endif
-}
-
-int main() {
-    // Initialize
-    GameStatus *game = generateGame();
-    InputStatus *inputStatus = new InputStatus();
-    updateGameInfo(game);
-    while(game->m_isComplete) {
-        delete game;
-        game = generateGame();
+    SensorSource sensorSource;
+    if (sensorPath && !openSensorSource(&sensorSource, sensorPath)) {
+        fprintf(stderr, "Cannot open sensor source %s\n", sensorPath);
+        return 1;
     }
 
 #ifdef DEBUG_FLAG
-    printf("Initialized\n");
+    printf("Initialized with seed %llu\n", static_cast<unsigned long long>(seed));
 #endif
 
     printf("Usage:\n\nRight arrow(->) represent tuning next rail\n\nLeft arrow(<-) represent tuning previous rail\n\n         ^\nUp arrow(|) represent pull up current rail\n\nDown arrow(|) represent push down current rail\n           v\n\n");
-    printf("\n\n\nPress r to refresh GUI\n\n\nPress Enter to start");
+    printf("\n\n\nPress r to refresh GUI\n\n\nPress l to print latency histograms to stderr\n\n\nPress Enter to start");
     getchar();
 
-    bool dirtyFlag = true;
-
-    int currentInputRail = 0;
-    std::mutex dirtyMutex;
+    // Game loop and input threads still wait on it when the GUI thread returns, so it's never destroyed
+    GameEventQueue<Board> *eventQueue = new GameEventQueue<Board>();
+    TimerScheduler scheduler;
+    FrameBuffer<Board> frameBuffer;
+    LatencyRecorder *latencyRecorder = new LatencyRecorder();
+    startSignalThread(eventQueue);
+    // Only game loop writes game, other threads read published frames
+    captureGameFrame(game, &scheduler, beginGameFrame(&frameBuffer));
+    beginGameFrame(&frameBuffer)->m_stateDigest = traceStream.m_file ? gameStateDigest(game) : 0;
+    publishGameFrame(&frameBuffer);
+    // Draw the first frame
+    postGameEvent(eventQueue, REDRAW_EVENT);
+#ifdef OFFSET_HINT
+    HintSolver<Board> *hintSolver = new HintSolver<Board>();
+    startOffsetHintSolver(hintSolver, eventQueue, OffsetSpaceSolvedTag<Board>());
+    requestOffsetHint(hintSolver, game, OffsetSpaceSolvedTag<Board>());
+#endif
 
-    std::thread ([&] () {
-        // Input thread
-        const float PHYSICAL_INVERVAL = 0.3f;
-        while (true) {
-            int ch;
-            if ((ch = getch()) != 27) {
-                if (ch == 0 || ch == 224) { // if the first value is esc
-                    dirtyMutex.lock();
-                    dirtyFlag = true;
-                    switch (getch()) { // the real value
-                        case 72:
-                            // code for arrow up
-                            if(inputStatus->m_physicalOffset[currentInputRail] + PHYSICAL_INVERVAL > MAXIMUM_PHYSICAL_OFFSET_ON_RAIL) {
-                                inputStatus->m_physicalOffset[currentInputRail] = MAXIMUM_PHYSICAL_OFFSET_ON_RAIL;
-                            } else {
-                                inputStatus->m_physicalOffset[currentInputRail] = inputStatus->m_physicalOffset[currentInputRail] + PHYSICAL_INVERVAL;
-                            }
-                            railInputUpdate(inputStatus, game);
-                            break;
-                        case 80:
-                            // code for arrow down
-                            if(inputStatus->m_physicalOffset[currentInputRail] - PHYSICAL_INVERVAL < 0) {
-                                inputStatus->m_physicalOffset[currentInputRail] = 0;
-                            } else {
-                                inputStatus->m_physicalOffset[currentInputRail] = inputStatus->m_physicalOffset[currentInputRail] - PHYSICAL_INVERVAL;
-                            }
-                            railInputUpdate(inputStatus, game);
-                            break;
-                        case 77:
-                            // code for arrow right
-                            currentInputRail = (currentInputRail+1)>=SLIDING_RAIL_AMOUNT?currentInputRail:currentInputRail+1;
-                            break;
-                        case 75:
-                            // code for arrow left
-                            currentInputRail = (currentInputRail-1)<0?currentInputRail:currentInputRail-1;
-                            break;
+    if (sensorPath) {
+        std::thread([&] () {
+            // Sensor thread, one input event per batch of samples changing any level, current input rail is the
+            // last rail changed
+            SensorFilter<Board> *filter = new SensorFilter<Board>();
+            SensorSample sample[SENSOR_BATCH_CAPACITY];
+            size_t sampleAmount;
+            while ((sampleAmount = readSensorSample(&sensorSource, sample, SENSOR_BATCH_CAPACITY)) > 0) {
+                int changedRail = -1;
+                for (size_t i = 0; i < sampleAmount; ++i) {
+                    if (filterSensorSample(filter, &sample[i])) {
+                        changedRail = sample[i].m_rail;
                     }
-                    dirtyMutex.unlock();
                 }
-            } else if(ch == 'r' || ch == 'R') {
-                dirtyMutex.lock();
-                dirtyFlag = true;
-                dirtyMutex.unlock();
+                if (changedRail >= 0) {
+                    sensorInputStatus(filter, inputStatus);
+                    postInputEvent(eventQueue, inputStatus, changedRail);
+                }
             }
-        }
-    }).detach();
+            delete filter;
+        }).detach();
+    } else {
+        std::thread ([&] () {
+            // Input thread, owns inputStatus and hands a copy to game loop
+            const float PHYSICAL_INVERVAL = 0.3f;
+            int currentInputRail = 0;
+            while (true) {
+                int ch;
+                if ((ch = getch()) != 27) {
+                    if (ch == 0 || ch == 224) { // if the first value is esc
+                        switch (getch()) { // the real value
+                            case 72:
+                                // code for arrow up
+                                if(inputStatus->m_physicalOffset[currentInputRail] + PHYSICAL_INVERVAL > MAXIMUM_PHYSICAL_OFFSET_ON_RAIL) {
+                                    inputStatus->m_physicalOffset[currentInputRail] = MAXIMUM_PHYSICAL_OFFSET_ON_RAIL;
+                                } else {
+                                    inputStatus->m_physicalOffset[currentInputRail] = inputStatus->m_physicalOffset[currentInputRail] + PHYSICAL_INVERVAL;
+                                }
+                                break;
+                            case 80:
+                                // code for arrow down
+                                if(inputStatus->m_physicalOffset[currentInputRail] - PHYSICAL_INVERVAL < 0) {
+                                    inputStatus->m_physicalOffset[currentInputRail] = 0;
+                                } else {
+                                    inputStatus->m_physicalOffset[currentInputRail] = inputStatus->m_physicalOffset[currentInputRail] - PHYSICAL_INVERVAL;
+                                }
+                                break;
+                            case 77:
+                                // code for arrow right
+                                currentInputRail = (currentInputRail+1)>=Board::railAmount?currentInputRail:currentInputRail+1;
+                                break;
+                            case 75:
+                                // code for arrow left
+                                currentInputRail = (currentInputRail-1)<0?currentInputRail:currentInputRail-1;
+                                break;
+                        }
+                        postInputEvent(eventQueue, inputStatus, currentInputRail);
+                    } else if (ch == 'r' || ch == 'R') {
+                        postGameEvent(eventQueue, REFRESH_EVENT);
+                    } else if (ch == 'l' || ch == 'L') {
+                        postGameEvent(eventQueue, LATENCY_REPORT_EVENT);
+                    }
+                }
+            }
+        }).detach();
+    }
     time_t startTime = getCurrentTimeInSecond();
-    time_t currentTime = startTime;
+    auto sessionBegin = std::chrono::steady_clock::now();
+    initCheckpointTimer(&scheduler, sessionBegin);
+#ifdef IDLE_CPU_REPORT
+    // Refresh idle report even if nobody touches the rails
+    scheduleTimer(&scheduler, IDLE_REPORT_TIMER, sessionBegin + std::chrono::seconds(IDLE_CPU_REPORT_INTERVAL), std::chrono::seconds(IDLE_CPU_REPORT_INTERVAL));
+#endif
     std::thread([&] () {
-        // Time update loop thread
+        // Game loop thread, sleeps until input, timer deadline, checkpoint regeneration or solved hint
+        InputStatus<Board> loopInputStatus;
+        int loopInputRail = 0;
+        std::chrono::steady_clock::time_point latencyPoint[LATENCY_POINT_AMOUNT];
         while (true) {
-#ifdef _WIN32
-            Sleep(500);
-#elif __unix__
-            usleep(500000);
+            uint32_t event;
+            if (hasTimer(&scheduler)) {
+                event = waitGameEventUntil(eventQueue, INPUT_EVENT | CHECKPOINT_EVENT | HINT_EVENT, nextTimerDeadline(&scheduler));
+            } else {
+                event = waitGameEvent(eventQueue, INPUT_EVENT | CHECKPOINT_EVENT | HINT_EVENT);
+            }
+            if (event & INPUT_EVENT) {
+                takeInput(eventQueue, &loopInputStatus, &loopInputRail, &latencyPoint[INPUT_POSTED_POINT]);
+                latencyPoint[INPUT_TAKEN_POINT] = std::chrono::steady_clock::now();
+                railInputUpdate(&loopInputStatus, game);
+                latencyPoint[RAIL_UPDATED_POINT] = std::chrono::steady_clock::now();
+            }
+            if (event & (INPUT_EVENT | CHECKPOINT_EVENT)) {
+                updateGameInfo(game);
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (event & INPUT_EVENT) {
+                latencyPoint[GAME_UPDATED_POINT] = now;
+                recordGameLoopLatency(latencyRecorder, latencyPoint);
+            }
+            size_t idleReportAmount = scheduler.m_firedAmount[IDLE_REPORT_TIMER];
+            bool isRegenerated = eventDrivenCheckpointUpdate(&scheduler, game, &engine, now);
+            if (scheduler.m_firedAmount[IDLE_REPORT_TIMER] != idleReportAmount) {
+                postGameEvent(eventQueue, REDRAW_EVENT);
+            }
+            if (isRegenerated) {
+                postGameEvent(eventQueue, CHECKPOINT_EVENT);
+#ifdef OFFSET_HINT
+                requestOffsetHint(hintSolver, game, OffsetSpaceSolvedTag<Board>());
+#endif
+            }
+            // Recorded before the frame is published, so a complete frame's wakeup is always in the trace
+            if (traceStream.m_file) {
+                InputTraceRecord<Board> record;
+                record.m_time = std::chrono::duration_cast<std::chrono::nanoseconds>(now - sessionBegin).count();
+                record.m_event = (event & (INPUT_EVENT | CHECKPOINT_EVENT)) | (isRegenerated ? TIMER_EVENT : 0);
+                record.m_currentInputRail = loopInputRail;
+                record.m_inputStatus = loopInputStatus;
+                writeInputTraceRecord(&traceStream, &record);
+            }
+            if ((event & (INPUT_EVENT | CHECKPOINT_EVENT | HINT_EVENT)) || isRegenerated) {
+                GameFrame<Board> *frame = beginGameFrame(&frameBuffer);
+                captureGameFrame(game, &scheduler, frame);
+                frame->m_inputStatus = loopInputStatus;
+                frame->m_currentInputRail = loopInputRail;
+                frame->m_stateDigest = traceStream.m_file ? gameStateDigest(game) : 0;
+#ifdef OFFSET_HINT
+                queryOffsetHint(hintSolver, game, &frame->m_hint, OffsetSpaceSolvedTag<Board>());
 #endif
-            currentTime = getCurrentTimeInSecond();
-            // Toggle time update
-            // dirtyMutex.lock();
-            // dirtyFlag = true;
-            // dirtyMutex.unlock();
-            // printf("Update time\n");
+                if (event & INPUT_EVENT) {
+                    latencyPoint[FRAME_PUBLISHED_POINT] = std::chrono::steady_clock::now();
+                    memcpy(frame->m_latencyPoint, latencyPoint, sizeof(frame->m_latencyPoint));
+                    frame->m_hasInputLatency = true;
+                }
+                publishGameFrame(&frameBuffer);
+                postGameEvent(eventQueue, REDRAW_EVENT);
+            }
         }
     }).detach();
 
     std::thread([&] () {
-        // Game loop thread
+        // GUI thread, redraws latest published frame
+        const GameFrame<Board> *frame = consumeGameFrame(&frameBuffer);
+        ScreenBuffer *screen = new ScreenBuffer();
+        bool isQuit = false;
         while (true) {
-            updateGameInfo(game);
-            eventDrivenCheckpointUpdate(getDiffSecond(startTime, currentTime), game);
-        }
-    }).detach();
-
-    std::thread([&] () {
-        // GUI thread
-        while (!game->m_isComplete) {
-            if (dirtyFlag) {
-                // update GUI
-                system("cls");
-                printGraph(game);
-#ifdef DEBUG_FLAG
-                printf("\n\nCurrent time is %lf(s)\n", getDiffSecond(startTime, currentTime));
-                printf("\n\nCurrent input rail: %d\n", currentInputRail);
-                printf("\nPhysical offsets are (%f, %f, %f, %f)\n", inputStatus->m_physicalOffset[0], inputStatus->m_physicalOffset[1], inputStatus->m_physicalOffset[2], inputStatus->m_physicalOffset[3]);
-                printf("\nLogical rail offsets are (%d, %d, %d, %d)\n", game->m_railStatusList[0].m_offset, game->m_railStatusList[1].m_offset, game->m_railStatusList[2].m_offset, game->m_railStatusList[3].m_offset);
-                printf("\nRail bars:\n");
-                for (int i = 0; i < SLIDING_RAIL_AMOUNT; ++i) {
-                    std::cout << std::bitset<32>((uint32_t)(game->m_railStatusList[i].m_activeBar) << game->m_railStatusList[i].m_offset) << std::endl;
-                }
-                printf("\nTrack history:\n");
-                for (int i = 0; i < MAXIMUM_INTERLEAVE_TRACK_POS; ++i) {
-                    std::cout << game->m_currentTrackHistory[i] << " ";
+            uint32_t event = waitGameEvent(eventQueue, REDRAW_EVENT | REFRESH_EVENT | LATENCY_REPORT_EVENT | QUIT_EVENT);
+            if (event & QUIT_EVENT) {
+                isQuit = true;
+                break;
+            }
+            if (event & LATENCY_REPORT_EVENT) {
+                // Report stays on terminal until next redraw, which has to repaint the whole screen
+                printLatencyReport(stderr, latencyRecorder);
+                screen->m_isShown = false;
+                if (!(event & (REDRAW_EVENT | REFRESH_EVENT))) {
+                    continue;
                 }
-                printf("\nCheckpoint:\n");
-                for (int i = 0; i < TRACK_AMOUNT; ++i) {
-                    std::cout << std::bitset<64>(game->m_trackStatusList[i].m_checkpoint) << std::endl;
+            }
+            if (event & REFRESH_EVENT) {
+                screen->m_isShown = false;
+            }
+            const GameFrame<Board> *latestFrame = consumeGameFrame(&frameBuffer);
+            // Input latency is measured once per frame, on the redraw that first shows it
+            bool isFreshInputFrame = latestFrame && latestFrame->m_hasInputLatency;
+            if (latestFrame) {
+                frame = latestFrame;
+            }
+            if (frame->m_isComplete) {
+                break;
+            }
+            // update GUI
+            clearScreenBuffer(screen);
+            printGraph(frame, screen);
+#if defined(TOGGLE_SOLUTION) && defined(OFFSET_HINT)
+            if (Board::isOffsetSpaceSolved) {
+                if (frame->m_hint.m_distance == HINT_UNREACHABLE) {
+                    screenPrintf(screen, "\nHint: solving\n");
+                } else if (frame->m_hint.m_rail >= 0) {
+                    screenPrintf(screen, "\nHint: %s rail %d by %d, %d offset steps to an answer\n", frame->m_hint.m_step > 0 ? "pull up" : "push down", frame->m_hint.m_rail, std::abs(frame->m_hint.m_step), frame->m_hint.m_distance);
                 }
+            }
+#endif
+#ifdef DEBUG_FLAG
+            screenPrintf(screen, "\n\nCurrent time is %lf(s)\n", getDiffSecond(startTime, getCurrentTimeInSecond()));
+            screenPrintf(screen, "\n\nCurrent input rail: %d\n", frame->m_currentInputRail);
+            screenPrintf(screen, "\nPhysical offsets are (");
+            for (int i = 0; i < Board::railAmount; ++i) {
+                screenPrintf(screen, i ? ", %f" : "%f", frame->m_inputStatus.m_physicalOffset[i]);
+            }
+            screenPrintf(screen, ")\n\nLogical rail offsets are (");
+            for (int i = 0; i < Board::railAmount; ++i) {
+                screenPrintf(screen, i ? ", %zu" : "%zu", frame->m_railStatusList[i].m_offset);
+            }
+            screenPrintf(screen, ")\n");
+            screenPrintf(screen, "\nRail bars:\n");
+            for (int i = 0; i < Board::railAmount; ++i) {
+                screenPrintf(screen, "%s\n", maskString(frame->m_railStatusList[i].m_activeBar, 2 * Board::barAmount, frame->m_railStatusList[i].m_offset).c_str());
+            }
+            screenPrintf(screen, "\nTrack history:\n");
+            for (int i = 0; i < Board::interleaveTrackPosAmount; ++i) {
+                screenPrintf(screen, "%d ", frame->m_currentTrackHistory[i]);
+            }
+            screenPrintf(screen, "\nCheckpoint:\n");
+            for (int i = 0; i < Board::trackAmount; ++i) {
+                screenPrintf(screen, "%s\n", maskString(frame->m_trackStatusList[i].m_checkpoint, Board::interleaveTrackPosAmount).c_str());
+            }
 
-                printf("\nGame start track is %d, end track is %d, current setting's end track is %d\n", game->m_startTrack, game->m_endTrack, game->m_currentEndTrack);
-                printf("\nAchieved checkpoint amount is %d\n", game->m_achievedCheckpoint);
-                printf("\nAdvice rail offsets are (%d, %d, %d, %d)\n", game->m_railStatusList[0].m_adviceCompleteOffset, game->m_railStatusList[1].m_adviceCompleteOffset, game->m_railStatusList[2].m_adviceCompleteOffset, game->m_railStatusList[3].m_adviceCompleteOffset);
-                printf("\nProgress bar: %f\n", game->m_progressBar);
-                printf("\nDebug: %f\n", game->m_debug);
+            screenPrintf(screen, "\nGame start track is %d, end track is %d, current setting's end track is %d\n", frame->m_startTrack, frame->m_endTrack, frame->m_currentEndTrack);
+            screenPrintf(screen, "\nAchieved checkpoint amount is %d\n", frame->m_achievedCheckpoint);
+            screenPrintf(screen, "\nAdvice rail offsets are (");
+            for (int i = 0; i < Board::railAmount; ++i) {
+                screenPrintf(screen, i ? ", %zu" : "%zu", frame->m_railStatusList[i].m_adviceCompleteOffset);
+            }
+            screenPrintf(screen, ")\n");
+            screenPrintf(screen, "\nProgress bar: %f\n", frame->m_progressBar);
+            screenPrintf(screen, "\nRe-traced positions: %zu, average %lf per update\n", frame->m_retracedPosition, frame->m_averageRetracedPosition);
+#ifdef OFFSET_LOOKUP_TABLE
+            screenPrintf(screen, "\nLookup table: %zu bytes, built in %lf(ms), %zu complete offset tuples\n", frame->m_lookupTableSize, frame->m_lookupBuildTime * 1e3, frame->m_lookupSolutionAmount);
+#endif
+            screenPrintf(screen, "\nFired timers: time trigger %zu, checkpoint trigger %zu\n", frame->m_firedAmount[TIME_TRIGGER_TIMER], frame->m_firedAmount[CHECKPOINT_TRIGGER_TIMER]);
+            double elapsedFrameSecond = std::max(getDiffSecond(startTime, getCurrentTimeInSecond()), 1.0);
+            screenPrintf(screen, "\nFrame %llu: published %zu (%lf per second), consumed %zu (%lf per second), dropped %zu\n", static_cast<unsigned long long>(frame->m_version), frameBuffer.m_publishAmount.load(), frameBuffer.m_publishAmount / elapsedFrameSecond, frameBuffer.m_consumeAmount.load(), frameBuffer.m_consumeAmount / elapsedFrameSecond, frameBuffer.m_droppedAmount.load());
+            screenPrintf(screen, "\nScreen: %zu bytes last frame, %lf bytes per frame\n", screen->m_frameByte, static_cast<double>(screen->m_totalByte) / std::max<size_t>(screen->m_frameAmount, 1));
+            screenPrintf(screen, "\nDebug: %f\n", frame->m_debug);
+#endif
+#ifdef IDLE_CPU_REPORT
+            double elapsedSecond = std::max(getDiffSecond(startTime, getCurrentTimeInSecond()), 1.0);
+            screenPrintf(screen, "\nIdle report: CPU usage %lf%%, %zu wakeups (%lf per second)\n", getProcessCpuSecond() / elapsedSecond * 100.0, eventQueue->m_wakeupAmount, eventQueue->m_wakeupAmount / elapsedSecond);
 #endif
-                dirtyMutex.lock();
-                dirtyFlag = false;
-                dirtyMutex.unlock();
+            flushScreenBuffer(screen, stdout);
+            if (isFreshInputFrame) {
+                std::chrono::steady_clock::time_point latencyPoint[LATENCY_POINT_AMOUNT];
+                memcpy(latencyPoint, frame->m_latencyPoint, sizeof(latencyPoint));
+                latencyPoint[FRAME_FLUSHED_POINT] = std::chrono::steady_clock::now();
+                recordFlushLatency(latencyRecorder, latencyPoint);
             }
         }
-        std::cout << "Game Over" << std::endl;
+        std::cout << (isQuit ? "Quit" : "Game Over") << std::endl;
+        if (tracePath) {
+            // Same digest as --replay of the trace reports, from the latest frame as game loop keeps running
+            const GameFrame<Board> *latestFrame = consumeGameFrame(&frameBuffer);
+            frame = latestFrame ? latestFrame : frame;
+            printf("Final state digest %016llx\n", static_cast<unsigned long long>(frame->m_stateDigest));
+        }
+        printLatencyReport(stdout, latencyRecorder);
     }).join();
+    return 0;
+}
+
+template <typename Board>
+struct PuzzleBankBuildTask {
+    static int run (const char *path, size_t boardAmount, int threadAmount, uint64_t seed, const DifficultyBand *band) { return runPuzzleBankBuild<Board>(path, boardAmount, threadAmount, seed, band); }
+};
+
+template <typename Board>
+struct DifficultyAnalysisTask {
+    static int run (size_t boardAmount, int threadAmount, uint64_t seed, const DifficultyBand *band) { return runDifficultyAnalysis<Board>(boardAmount, threadAmount, seed, band); }
+};
+
+template <typename Board>
+struct BatchSimulationTask {
+    // Bands need the exact fewest move steps only a solved offset space gives
+    static int run (size_t boardAmount, int threadAmount, uint64_t seed, const DifficultyBand *band, bool isExactSolve) {
+        return (isExactSolve || band) ? runBatchSimulation<Board>(boardAmount, threadAmount, seed, band) : runBatchSimulation<SampledBoard<Board> >(boardAmount, threadAmount, seed, band);
+    }
+};
+
+template <typename Board>
+struct SessionTask {
+    static int run (size_t sessionAmount, int threadAmount, uint64_t seed, double updateRate, const char *endpointPath, const PuzzleBank *bank) { return runSessionEngine<Board>(sessionAmount, threadAmount, seed, updateRate, endpointPath, bank); }
+};
+
+template <typename Board>
+struct GameTask {
+    static int run (uint64_t seed, const char *tracePath, const char *sensorPath, const PuzzleBank *bank, int bankBucket) { return runGame<Board>(seed, tracePath, sensorPath, bank, bankBucket); }
+};
+
+template <typename Board>
+struct ReplayTask {
+    static int run (FILE *file, const InputTraceHeader *header, bool isRealTime) { return runReplay<Board>(file, header, isRealTime); }
+};
+
+int main(int argc, char **argv) {
+    // --rails [rail amount] picks the board size, --record [trace file] records the game, --sensor [source] reads
+    // rails from encoder samples, --endpoint [source] and --rate [updates per second] feed sessions, --bank [bank file]
+    // and --difficulty [bucket] pick boards from a puzzle bank, --band [lowest step] [highest step] keeps generated
+    // boards within fewest move steps, --exact makes batch simulation solve the offset space per board instead of
+    // drawing advice offsets by rejection sampling, other arguments are positional
+    int railAmount = ShippingBoard::railAmount;
+    const char *tracePath = nullptr;
+    const char *sensorPath = nullptr;
+    const char *endpointPath = nullptr;
+    const char *bankPath = nullptr;
+    int bankBucket = -1;
+    DifficultyBand bandStorage = {0, UINT32_MAX};
+    const DifficultyBand *band = nullptr;
+    bool isExactSolve = false;
+    double updateRate = SESSION_UPDATE_RATE;
+    std::vector<char *> argumentList;
+    for (int i = 0; i < argc; ++i) {
+        if (strcmp(argv[i], "--rails") == 0 && i + 1 < argc) {
+            railAmount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--sensor") == 0 && i + 1 < argc) {
+            sensorPath = argv[++i];
+        } else if (strcmp(argv[i], "--endpoint") == 0 && i + 1 < argc) {
+            endpointPath = argv[++i];
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            updateRate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--bank") == 0 && i + 1 < argc) {
+            bankPath = argv[++i];
+        } else if (strcmp(argv[i], "--difficulty") == 0 && i + 1 < argc) {
+            bankBucket = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--band") == 0 && i + 2 < argc) {
+            bandStorage.m_lowestStep = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            bandStorage.m_highestStep = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            band = &bandStorage;
+        } else if (strcmp(argv[i], "--exact") == 0) {
+            isExactSolve = true;
+        } else {
+            argumentList.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(argumentList.size());
+    argv = argumentList.data();
+
+    // simulate --build-bank [bank file] [board amount] [thread amount] [seed]
+    if (argc > 2 && strcmp(argv[1], "--build-bank") == 0) {
+        size_t boardAmount = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1024;
+        int threadAmount = argc > 4 ? atoi(argv[4]) : std::max<int>(std::thread::hardware_concurrency(), 1);
+        uint64_t seed = argc > 5 ? strtoull(argv[5], nullptr, 10) : time(nullptr);
+        return dispatchBoardSize<PuzzleBankBuildTask>(railAmount, argv[2], boardAmount, threadAmount, seed, band);
+    }
+
+    // simulate --analyze [board amount] [thread amount] [seed]
+    if (argc > 1 && strcmp(argv[1], "--analyze") == 0) {
+        size_t boardAmount = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000;
+        int threadAmount = argc > 3 ? atoi(argv[3]) : std::max<int>(std::thread::hardware_concurrency(), 1);
+        uint64_t seed = argc > 4 ? strtoull(argv[4], nullptr, 10) : time(nullptr);
+        return dispatchBoardSize<DifficultyAnalysisTask>(railAmount, boardAmount, threadAmount, seed, band);
+    }
+
+    // Rounds fall back to generated boards when the bank can't be used, it stays mapped until the process exits
+    PuzzleBank *bank = bankPath ? openPuzzleBank(bankPath) : nullptr;
+    if (bankPath && !bank) {
+        fprintf(stderr, "Cannot map puzzle bank %s, boards are generated\n", bankPath);
+    }
+
+    // simulate --batch [board amount] [thread amount] [seed]
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        size_t boardAmount = argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000;
+        int threadAmount = argc > 3 ? atoi(argv[3]) : std::max<int>(std::thread::hardware_concurrency(), 1);
+        uint64_t seed = argc > 4 ? strtoull(argv[4], nullptr, 10) : time(nullptr);
+        return dispatchBoardSize<BatchSimulationTask>(railAmount, boardAmount, threadAmount, seed, band, isExactSolve);
+    }
+
+    // simulate --sessions [session amount] [thread amount] [seed]
+    if (argc > 1 && strcmp(argv[1], "--sessions") == 0) {
+        size_t sessionAmount = argc > 2 ? strtoull(argv[2], nullptr, 10) : 4096;
+        int threadAmount = argc > 3 ? atoi(argv[3]) : std::max<int>(std::thread::hardware_concurrency(), 1);
+        uint64_t seed = argc > 4 ? strtoull(argv[4], nullptr, 10) : time(nullptr);
+        return dispatchBoardSize<SessionTask>(railAmount, sessionAmount, threadAmount, seed, updateRate, endpointPath, bank);
+    }
+
+    // simulate --replay [trace file] [--realtime], board size, board and seed come from the trace
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        FILE *file = fopen(argv[2], "rb");
+        InputTraceHeader header;
+        if (!file || !readInputTraceHeader(file, &header)) {
+            fprintf(stderr, "Cannot read trace %s\n", argv[2]);
+            return 1;
+        }
+        bool isRealTime = argc > 3 && strcmp(argv[3], "--realtime") == 0;
+        int result = dispatchBoardSize<ReplayTask>(header.m_railAmount, file, &header, isRealTime);
+        fclose(file);
+        return result;
+    }
+
+    // simulate --seed [seed] replays the same boards and checkpoints
+    uint64_t seed = (argc > 2 && strcmp(argv[1], "--seed") == 0) ? strtoull(argv[2], nullptr, 10) : time(nullptr);
+    return dispatchBoardSize<GameTask>(railAmount, seed, tracePath, sensorPath, bank, bankBucket);
 }
+#endif